@@ -0,0 +1,262 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include "CAN_common.h"
+#include "CANManager.h"
+
+#define CAN_BRIDGE_ID_SPACE 0x0800   // base CAN frame format: 11-bit IDs
+#define CAN_BRIDGE_NO_ROUTE UINT8_MAX // route index for IDs without routes
+
+// Route of the CANBridge: frames with src_id from the src_bus are forwarded to all buses of dst_bus_mask with dst_id
+struct can_route_t
+{
+    uint8_t src_bus = 0;
+    uint8_t dst_bus_mask = 0; // bit N is set if the frame should be forwarded to the bus N
+    can_object_id_t src_id = 0;
+    can_object_id_t dst_id = 0; // ID translation: src_id is replaced by dst_id
+    uint32_t function_mask[256 / 32] = {0}; // bit N is set if the function ID N is forwarded
+    uint16_t min_interval_ms = 0;           // rate limit: the minimal period between forwarded frames, 0 if not limited
+    bool was_forwarded = false;
+    uint32_t last_forward_time = 0;
+
+    // statistics
+    uint32_t forwarded_count = 0;
+    uint32_t filtered_count = 0;
+    uint32_t rate_limited_count = 0;
+};
+
+/******************************************************************************************
+ ******************************************************************************************/
+/// @brief CANBridge forwards selected frames between several CANManagers (CAN buses).
+///        Routes are looked up by ID in O(1) with a direct index table (CAN_BRIDGE_ID_SPACE bytes per bus).
+///        Frames are passed from the incoming buffer of the source CANManager directly to the sending path of the destination ones.
+/// @tparam _max_buses — The maximum number of CANManagers connected to the bridge (up to 8)
+/// @tparam _max_routes — The maximum number of routes
+template <uint8_t _max_buses = 2, uint8_t _max_routes = 16>
+class CANBridge : public CANFrameForwarderInterface
+{
+    static_assert(_max_buses > 0 && _max_buses <= 8); // bus mask is 8-bit wide
+    static_assert(_max_routes > 0 && _max_routes < CAN_BRIDGE_NO_ROUTE);
+public:
+    CANBridge()
+    {
+        memset(_route_index, CAN_BRIDGE_NO_ROUTE, sizeof(_route_index));
+    };
+
+    virtual ~CANBridge() = default;
+
+    /// @brief Connects CANManager to the bridge. The CANManager gets the bus ID as its manager ID.
+    /// @param bus_id ID of the bus, less than _max_buses
+    /// @param can_manager CANManager of the bus
+    /// @return 'true' if the CANManager was connected, 'false' if the bus ID is out of range
+    bool AttachBus(uint8_t bus_id, CANManagerInterface &can_manager)
+    {
+        if (bus_id >= _max_buses)
+            return false;
+
+        _managers[bus_id] = &can_manager;
+        can_manager.SetManagerId(bus_id);
+        can_manager.RegisterForwarder(this);
+
+        return true;
+    }
+
+    /// @brief Adds route for the frames with specified ID. All function IDs are forwarded by default.
+    /// @param src_bus ID of the source bus
+    /// @param src_id CAN frame ID on the source bus
+    /// @param dst_bus_mask Destination buses: bit N is set if the frame should be forwarded to the bus N. The source bus is ignored.
+    /// @param dst_id CAN frame ID on the destination buses: the same as src_id or the translated one
+    /// @param min_interval_ms Rate limit: the minimal period between forwarded frames, 0 if not limited
+    /// @return Index of the route or CAN_BRIDGE_NO_ROUTE if the route can't be added
+    ///         (out of range values, duplicate route, routes limit reached or the route forms a loop).
+    uint8_t AddRoute(uint8_t src_bus, can_object_id_t src_id, uint8_t dst_bus_mask, can_object_id_t dst_id, uint16_t min_interval_ms = 0)
+    {
+        if (src_bus >= _max_buses)
+            return CAN_BRIDGE_NO_ROUTE;
+
+        dst_bus_mask &= (uint8_t)((1u << _max_buses) - 1);
+        dst_bus_mask &= (uint8_t)~(1u << src_bus); // frames never go back to the source bus
+
+        if (dst_bus_mask == 0 ||
+            src_id >= CAN_BRIDGE_ID_SPACE || dst_id >= CAN_BRIDGE_ID_SPACE ||
+            _routes_count >= _max_routes ||
+            _route_index[src_bus][src_id] != CAN_BRIDGE_NO_ROUTE)
+            return CAN_BRIDGE_NO_ROUTE;
+
+        // loop prevention: the forwarded frame must not be able to come back to the source bus with the source ID
+        for (uint8_t bus = 0; bus < _max_buses; bus++)
+        {
+            if ((dst_bus_mask & (1u << bus)) && _LeadsTo(bus, dst_id, src_bus, src_id, _max_buses))
+                return CAN_BRIDGE_NO_ROUTE;
+        }
+
+        can_route_t &route = _routes[_routes_count];
+        route = {};
+        route.src_bus = src_bus;
+        route.dst_bus_mask = dst_bus_mask;
+        route.src_id = src_id;
+        route.dst_id = dst_id;
+        route.min_interval_ms = min_interval_ms;
+        memset(route.function_mask, 0xFF, sizeof(route.function_mask));
+
+        _route_index[src_bus][src_id] = _routes_count;
+
+        return _routes_count++;
+    }
+
+    /// @brief Allows or denies forwarding of the function ID for the route
+    /// @param route_idx Index of the route
+    /// @param function_id CAN function ID
+    /// @param allowed 'true' if the frames with this function ID should be forwarded
+    /// @return 'true' if the route exists, 'false' if not
+    bool SetRouteFunction(uint8_t route_idx, can_function_id_t function_id, bool allowed)
+    {
+        if (route_idx >= _routes_count)
+            return false;
+
+        uint32_t &mask_word = _routes[route_idx].function_mask[function_id >> 5];
+        if (allowed)
+            mask_word |= (uint32_t)1 << (function_id & 0x1F);
+        else
+            mask_word &= ~((uint32_t)1 << (function_id & 0x1F));
+
+        return true;
+    }
+
+    /// @brief Denies forwarding of all function IDs for the route. Use SetRouteFunction() to allow the needed ones.
+    /// @param route_idx Index of the route
+    /// @return 'true' if the route exists, 'false' if not
+    bool ClearRouteFunctions(uint8_t route_idx)
+    {
+        if (route_idx >= _routes_count)
+            return false;
+
+        memset(_routes[route_idx].function_mask, 0, sizeof(_routes[route_idx].function_mask));
+
+        return true;
+    }
+
+    /// @brief Returns the route
+    /// @param route_idx Index of the route
+    /// @return Pointer to the route or nullptr if the route doesn't exist
+    const can_route_t *GetRoute(uint8_t route_idx)
+    {
+        if (route_idx >= _routes_count)
+            return nullptr;
+
+        return &_routes[route_idx];
+    }
+
+    /// @brief Returns the number of routes
+    /// @return The number of routes
+    uint8_t GetRoutesCount()
+    {
+        return _routes_count;
+    }
+
+    /// @brief Checks whether incoming frame should be forwarded. It is called from IncomingCANFrame(), so it should be fast.
+    /// @param manager_id ID of the CANManager which received the frame
+    /// @param id CANObject ID from the CAN frame
+    /// @param function_id CAN function ID from the CAN frame
+    /// @return 'true' if the frame should be stored in the buffer and forwarded later
+    virtual bool IsForwarded(uint8_t manager_id, can_object_id_t id, can_function_id_t function_id) override
+    {
+        const can_route_t *route = _FindRoute(manager_id, id);
+        return route != nullptr && _IsFunctionAllowed(*route, function_id);
+    }
+
+    /// @brief Forwards incoming frame. It is called from Process() with the frame from the incoming buffer.
+    /// @param manager_id ID of the CANManager which received the frame
+    /// @param can_frame Incoming CAN frame. It should not be changed.
+    virtual void ForwardFrame(uint8_t manager_id, const can_frame_t &can_frame) override
+    {
+        can_route_t *route = _FindRoute(manager_id, can_frame.object_id);
+        if (route == nullptr)
+            return;
+
+        if (!_IsFunctionAllowed(*route, can_frame.function_id))
+        {
+            route->filtered_count++;
+            return;
+        }
+
+        if (route->min_interval_ms > 0 && route->was_forwarded &&
+            can_frame.time_ms - route->last_forward_time < route->min_interval_ms)
+        {
+            route->rate_limited_count++;
+            return;
+        }
+
+        route->was_forwarded = true;
+        route->last_forward_time = can_frame.time_ms;
+        route->forwarded_count++;
+
+        for (uint8_t bus = 0; bus < _max_buses; bus++)
+        {
+            if ((route->dst_bus_mask & (1u << bus)) == 0 || _managers[bus] == nullptr)
+                continue;
+
+            _managers[bus]->SendRawFrame(route->dst_id, can_frame.raw_data, can_frame.raw_data_length);
+        }
+    }
+
+private:
+    CANManagerInterface *_managers[_max_buses] = {nullptr};
+
+    can_route_t _routes[_max_routes] = {};
+    uint8_t _routes_count = 0;
+
+    // direct index of routes: bus ID → CAN frame ID → route index
+    uint8_t _route_index[_max_buses][CAN_BRIDGE_ID_SPACE];
+
+    /// @brief Searches for the route
+    /// @param bus_id ID of the source bus
+    /// @param id CAN frame ID on the source bus
+    /// @return Pointer to the route or nullptr if the frame isn't routed
+    can_route_t *_FindRoute(uint8_t bus_id, can_object_id_t id)
+    {
+        if (bus_id >= _max_buses || id >= CAN_BRIDGE_ID_SPACE)
+            return nullptr;
+
+        uint8_t route_idx = _route_index[bus_id][id];
+        if (route_idx == CAN_BRIDGE_NO_ROUTE)
+            return nullptr;
+
+        return &_routes[route_idx];
+    }
+
+    /// @brief Checks if the function ID is forwarded by the route
+    /// @param route The route to check
+    /// @param function_id CAN function ID
+    /// @return 'true' if the function ID is forwarded
+    static bool _IsFunctionAllowed(const can_route_t &route, can_function_id_t function_id)
+    {
+        return (route.function_mask[function_id >> 5] & ((uint32_t)1 << (function_id & 0x1F))) != 0;
+    }
+
+    /// @brief Checks whether the frame from the bus can reach the target bus with the target ID through existing routes
+    /// @param bus ID of the bus where the frame appears
+    /// @param id CAN frame ID on this bus
+    /// @param target_bus ID of the target bus
+    /// @param target_id CAN frame ID on the target bus
+    /// @param hops_left The maximum number of hops to check
+    /// @return 'true' if the target is reachable
+    bool _LeadsTo(uint8_t bus, can_object_id_t id, uint8_t target_bus, can_object_id_t target_id, uint8_t hops_left)
+    {
+        if (bus == target_bus && id == target_id)
+            return true;
+
+        const can_route_t *route = _FindRoute(bus, id);
+        if (route == nullptr || hops_left == 0)
+            return false;
+
+        for (uint8_t next_bus = 0; next_bus < _max_buses; next_bus++)
+        {
+            if ((route->dst_bus_mask & (1u << next_bus)) &&
+                _LeadsTo(next_bus, route->dst_id, target_bus, target_id, hops_left - 1))
+                return true;
+        }
+        return false;
+    }
+};
@@ -0,0 +1,143 @@
+#include "CANBulkDecoder.h"
+
+#if defined(__linux__)
+
+// SIMD filters need 16-byte records of classic frames; CAN FD records are filtered by the scalar code
+#if (defined(__x86_64__) || defined(__i386__)) && CAN_FRAME_MAX_PAYLOAD == 7
+#include <immintrin.h>
+#define CAN_DECODE_X86
+static_assert(sizeof(can_capture_record_t) == 16); // one record per SSE register, two per AVX register
+#endif
+
+/*******************************************************************************************\
+ *
+ * Key of the record: the 32-bit word at offset 4 is object_id | manager_id << 16 | flags << 24
+ *
+\*******************************************************************************************/
+static inline void get_filter_key(can_object_id_t id, uint8_t manager_id, uint32_t &key, uint32_t &key_mask)
+{
+    key = id;
+    key_mask = 0x0000FFFF;
+    if (manager_id != CAN_DECODE_ANY_MANAGER)
+    {
+        key |= (uint32_t)manager_id << 16;
+        key_mask |= 0x00FF0000;
+    }
+}
+
+uint32_t can_decode_filter_id_scalar(const can_capture_record_t *records, uint32_t count, can_object_id_t id, uint8_t manager_id, uint32_t *indexes)
+{
+    uint32_t key, key_mask;
+    get_filter_key(id, manager_id, key, key_mask);
+
+    const uint8_t *bytes = (const uint8_t *)records;
+    uint32_t found = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t word;
+        memcpy(&word, bytes + i * sizeof(can_capture_record_t) + 4, sizeof(word));
+        // branchless: the index is always written, the counter moves on match only
+        indexes[found] = i;
+        found += ((word & key_mask) == key);
+    }
+    return found;
+}
+
+#if defined(CAN_DECODE_X86)
+__attribute__((target("sse2")))
+static uint32_t filter_id_sse2(const can_capture_record_t *records, uint32_t count, uint32_t key, uint32_t key_mask, uint32_t *indexes)
+{
+    // only the key word of the record is compared: other words are masked to 0 and compared with ~0
+    const __m128i mask = _mm_set_epi32(0, 0, (int)key_mask, 0);
+    const __m128i pattern = _mm_set_epi32(-1, -1, (int)key, -1);
+    const uint8_t *bytes = (const uint8_t *)records;
+
+    uint32_t found = 0;
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i *src = (const __m128i *)(bytes + i * sizeof(can_capture_record_t));
+        uint32_t matches = 0;
+        for (uint8_t j = 0; j < 4; j++)
+        {
+            __m128i cmp = _mm_cmpeq_epi32(_mm_and_si128(_mm_loadu_si128(src + j), mask), pattern);
+            matches |= (uint32_t)((_mm_movemask_ps(_mm_castsi128_ps(cmp)) >> 1) & 1) << j;
+        }
+        while (matches != 0)
+        {
+            indexes[found++] = i + __builtin_ctz(matches);
+            matches &= matches - 1;
+        }
+    }
+
+    if (i < count)
+    {
+        uint32_t tail_found = can_decode_filter_id_scalar(records + i, count - i, key & 0xFFFF,
+                                                          (key_mask & 0x00FF0000) ? (uint8_t)(key >> 16) : CAN_DECODE_ANY_MANAGER, indexes + found);
+        for (uint32_t j = 0; j < tail_found; j++)
+            indexes[found + j] += i;
+        found += tail_found;
+    }
+    return found;
+}
+
+__attribute__((target("avx2")))
+static uint32_t filter_id_avx2(const can_capture_record_t *records, uint32_t count, uint32_t key, uint32_t key_mask, uint32_t *indexes)
+{
+    // two records per register: words 1 and 5 are the keys
+    const __m256i mask = _mm256_set_epi32(0, 0, (int)key_mask, 0, 0, 0, (int)key_mask, 0);
+    const __m256i pattern = _mm256_set_epi32(-1, -1, (int)key, -1, -1, -1, (int)key, -1);
+    const uint8_t *bytes = (const uint8_t *)records;
+
+    uint32_t found = 0;
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256i *src = (const __m256i *)(bytes + i * sizeof(can_capture_record_t));
+        uint32_t matches = 0;
+        for (uint8_t j = 0; j < 4; j++)
+        {
+            __m256i cmp = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_loadu_si256(src + j), mask), pattern);
+            uint32_t words = (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(cmp));
+            matches |= (((words >> 1) & 1) | ((words >> 4) & 2)) << (j * 2);
+        }
+        while (matches != 0)
+        {
+            indexes[found++] = i + __builtin_ctz(matches);
+            matches &= matches - 1;
+        }
+    }
+
+    if (i < count)
+    {
+        uint32_t tail_found = filter_id_sse2(records + i, count - i, key, key_mask, indexes + found);
+        for (uint32_t j = 0; j < tail_found; j++)
+            indexes[found + j] += i;
+        found += tail_found;
+    }
+    return found;
+}
+#endif // CAN_DECODE_X86
+
+uint32_t can_decode_filter_id(const can_capture_record_t *records, uint32_t count, can_object_id_t id, uint8_t manager_id, uint32_t *indexes)
+{
+    if (records == nullptr || indexes == nullptr)
+        return 0;
+
+#if defined(CAN_DECODE_X86)
+    uint32_t key, key_mask;
+    get_filter_key(id, manager_id, key, key_mask);
+
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    if (has_avx2)
+        return filter_id_avx2(records, count, key, key_mask, indexes);
+
+    static const bool has_sse2 = __builtin_cpu_supports("sse2");
+    if (has_sse2)
+        return filter_id_sse2(records, count, key, key_mask, indexes);
+#endif
+
+    return can_decode_filter_id_scalar(records, count, id, manager_id, indexes);
+}
+
+#endif // __linux__
@@ -0,0 +1,116 @@
+#pragma once
+
+// Host-side bulk decoding of captured frames into per-item columns (time series).
+#if defined(__linux__)
+
+#include <stdint.h>
+#include <string.h>
+#include "CAN_common.h"
+#include "CAN_wire.h"
+#include "CANCapture.h"
+
+#define CAN_DECODE_ANY_MANAGER UINT8_MAX
+#define CAN_DECODE_CHUNK_SIZE 1024 // records filtered at once
+
+/// @brief Searches for the records of the CAN frame ID. It uses AVX2 or SSE2 when the CPU supports them.
+/// @param records Pointer to the records
+/// @param count The number of records
+/// @param id CAN frame ID
+/// @param manager_id Manager ID of the records or CAN_DECODE_ANY_MANAGER
+/// @param indexes [OUT] Indexes of the found records, count elements at most
+/// @return The number of found records
+uint32_t can_decode_filter_id(const can_capture_record_t *records, uint32_t count, can_object_id_t id, uint8_t manager_id, uint32_t *indexes);
+
+/// @brief The same as can_decode_filter_id() without SIMD: the reference implementation
+uint32_t can_decode_filter_id_scalar(const can_capture_record_t *records, uint32_t count, can_object_id_t id, uint8_t manager_id, uint32_t *indexes);
+
+/******************************************************************************************
+ ******************************************************************************************/
+/// @brief CANBulkDecoder decodes captured frames of the CANObject<T, _item_count> into columns: one array of times and
+///        one array of values per data field. Records are filtered by ID with SIMD, payloads of the matched ones are
+///        copied to the columns. By default the frames which carry data fields are decoded: timer frames and EVENT_OK.
+/// @tparam T — Type of the data fields of the CANObject
+/// @tparam _item_count — The number of data fields of the CANObject
+template <typename T, uint8_t _item_count>
+class CANBulkDecoder
+{
+    static_assert(_item_count > 0);
+    static_assert(_item_count * sizeof(T) <= CAN_FRAME_MAX_PAYLOAD);
+public:
+    /// @brief Creates CANBulkDecoder
+    /// @param id ID of the CANObject
+    /// @param manager_id Manager ID of the records (CAN bus) or CAN_DECODE_ANY_MANAGER
+    CANBulkDecoder(can_object_id_t id, uint8_t manager_id = CAN_DECODE_ANY_MANAGER)
+        : _id(id), _manager_id(manager_id)
+    {
+        SetFunction(CAN_FUNC_TIMER_NORMAL, true);
+        SetFunction(CAN_FUNC_TIMER_WARNING, true);
+        SetFunction(CAN_FUNC_TIMER_CRITICAL, true);
+        SetFunction(CAN_FUNC_EVENT_OK, true);
+    };
+
+    /// @brief Selects function IDs of decoded frames. Frames with other function IDs are skipped.
+    /// @param function_id CAN function ID
+    /// @param decoded 'true' if frames with this function ID should be decoded
+    void SetFunction(can_function_id_t function_id, bool decoded)
+    {
+        uint32_t &mask_word = _function_mask[function_id >> 5];
+        if (decoded)
+            mask_word |= (uint32_t)1 << (function_id & 0x1F);
+        else
+            mask_word &= ~((uint32_t)1 << (function_id & 0x1F));
+    }
+
+    /// @brief Decodes records into columns
+    /// @param records Pointer to the records (e.g. from CANCaptureFileReader)
+    /// @param count The number of records
+    /// @param times [OUT] Column of frame times, max_rows elements
+    /// @param columns [OUT] Columns of data fields: _item_count arrays of max_rows elements; nullptr columns are skipped
+    /// @param max_rows The maximum number of decoded frames
+    /// @param function_ids [OUT] Column of function IDs, max_rows elements; nullptr if not needed
+    /// @return The number of decoded frames (rows)
+    uint32_t Decode(const can_capture_record_t *records, uint32_t count, uint32_t *times, T *const columns[_item_count],
+                    uint32_t max_rows, uint8_t *function_ids = nullptr)
+    {
+        uint32_t indexes[CAN_DECODE_CHUNK_SIZE];
+        uint32_t rows = 0;
+        for (uint32_t chunk_start = 0; chunk_start < count && rows < max_rows; chunk_start += CAN_DECODE_CHUNK_SIZE)
+        {
+            uint32_t chunk_size = count - chunk_start;
+            if (chunk_size > CAN_DECODE_CHUNK_SIZE)
+                chunk_size = CAN_DECODE_CHUNK_SIZE;
+
+            const can_capture_record_t *chunk = records + chunk_start;
+            uint32_t found = can_decode_filter_id(chunk, chunk_size, _id, _manager_id, indexes);
+            for (uint32_t i = 0; i < found && rows < max_rows; i++)
+            {
+                const can_capture_record_t &record = chunk[indexes[i]];
+                uint8_t function_id = record.raw_data[0];
+                if (!can_is_frame_length_matched(record.flags & CAN_CAPTURE_LENGTH_MASK, _frame_length) ||
+                    (_function_mask[function_id >> 5] & ((uint32_t)1 << (function_id & 0x1F))) == 0)
+                    continue;
+
+                times[rows] = record.time_ms;
+                if (function_ids != nullptr)
+                    function_ids[rows] = function_id;
+                for (uint8_t item = 0; item < _item_count; item++)
+                {
+                    if (columns[item] != nullptr)
+                        can_wire_decode(&columns[item][rows], &record.raw_data[1 + item * sizeof(T)], 1);
+                }
+                rows++;
+            }
+        }
+
+        return rows;
+    }
+
+private:
+    static constexpr uint8_t _frame_length = 1 + _item_count * sizeof(T);
+
+    can_object_id_t _id;
+    uint8_t _manager_id;
+    uint32_t _function_mask[256 / 32] = {0}; // bit N is set if the function ID N is decoded
+};
+
+#endif // __linux__
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include "CAN_common.h"
+
+using can_time_function_t = uint32_t (*)();
+
+enum can_capture_direction_t : uint8_t
+{
+    CAN_CAPTURE_DIRECTION_RX = 0x00,
+    CAN_CAPTURE_DIRECTION_TX = 0x80,
+
+    CAN_CAPTURE_DIRECTION_MASK = 0x80,
+    CAN_CAPTURE_LENGTH_MASK = 0x7F,
+};
+
+// Fixed size capture record. It is also the record of the capture file (little-endian hosts).
+struct __attribute__((__packed__)) can_capture_record_t
+{
+    uint32_t time_ms;
+    can_object_id_t object_id;
+    uint8_t manager_id;
+    uint8_t flags; // can_capture_direction_t | raw data length
+    uint8_t raw_data[CAN_FRAME_MAX_PAYLOAD + 1];
+};
+
+/******************************************************************************************
+ *
+ ******************************************************************************************/
+class CANCaptureWriterInterface
+{
+public:
+    virtual ~CANCaptureWriterInterface() = default;
+
+    /// @brief Stores captured records (e.g. to the file)
+    /// @param records Pointer to the records
+    /// @param count The number of records
+    /// @return 'true' if the records were stored
+    virtual bool Write(const can_capture_record_t *records, uint16_t count) = 0;
+};
+
+/******************************************************************************************
+ *
+ ******************************************************************************************/
+class CANCaptureInterface
+{
+public:
+    virtual ~CANCaptureInterface() = default;
+
+    /// @brief Sets current time. CANManager calls it every Process(), so records get the time of the last tick
+    ///        if the time function isn't registered.
+    /// @param time Current time
+    virtual void SetTime(uint32_t time) = 0;
+
+    /// @brief Records the frame. It is called on the hot path (from ISR for incoming frames), so it should be fast.
+    /// @param direction Direction of the frame
+    /// @param manager_id ID of the CANManager
+    /// @param id CAN frame ID
+    /// @param data Frame data including function ID
+    /// @param length Frame data length including function ID
+    /// @param time_ms Time of the frame; 0 if unknown (current time will be used)
+    virtual void Capture(can_capture_direction_t direction, uint8_t manager_id, can_object_id_t id,
+                         const uint8_t *data, uint8_t length, uint32_t time_ms = 0) = 0;
+};
+
+/******************************************************************************************
+ ******************************************************************************************/
+/// @brief CANCapture records incoming and outgoing frames into preallocated RAM rings.
+///        Incoming and outgoing frames use separate single-producer rings, so IncomingCANFrame() may be called from ISR
+///        while Process() sends frames. Records are merged by time and passed to the writer by Flush() off the hot path.
+///        When a ring is full, new records are dropped and counted.
+///        Use one CANCapture per CANManager: the rings have a single producer, so managers of different CAN buses
+///        (nested CAN ISRs, threads of CANShardedRuntime) must not share it.
+/// @tparam _ring_size — The number of records in every ring (RX & TX), power of 2
+template <uint16_t _ring_size = 64>
+class CANCapture : public CANCaptureInterface
+{
+    static_assert(_ring_size > 0 && (_ring_size & (_ring_size - 1)) == 0); // power of 2 for fast index masking
+public:
+    /// @brief Creates CANCapture
+    /// @param time_func Function returning current time in milliseconds (e.g. HAL_GetTick). nullptr to use the time of the last tick.
+    CANCapture(can_time_function_t time_func = nullptr)
+        : _time_func(time_func){};
+
+    virtual ~CANCapture() = default;
+
+    /// @brief Enables or disables recording
+    /// @param enabled 'true' to record frames
+    void SetEnabled(bool enabled)
+    {
+        _enabled = enabled;
+    }
+
+    /// @brief Sets current time. CANManager calls it every Process(), so records get the time of the last tick
+    ///        if the time function isn't registered.
+    /// @param time Current time
+    virtual void SetTime(uint32_t time) override
+    {
+        _time = time;
+    }
+
+    /// @brief Records the frame. It is called on the hot path (from ISR for incoming frames), so it should be fast.
+    /// @param direction Direction of the frame
+    /// @param manager_id ID of the CANManager
+    /// @param id CAN frame ID
+    /// @param data Frame data including function ID
+    /// @param length Frame data length including function ID
+    /// @param time_ms Time of the frame; 0 if unknown (current time will be used)
+    virtual void Capture(can_capture_direction_t direction, uint8_t manager_id, can_object_id_t id,
+                         const uint8_t *data, uint8_t length, uint32_t time_ms = 0) override
+    {
+        if (!_enabled)
+            return;
+
+        ring_t &ring = (direction == CAN_CAPTURE_DIRECTION_TX) ? _tx_ring : _rx_ring;
+        uint16_t head = ring.head;
+        if ((uint16_t)(head - ring.tail) >= _ring_size)
+        {
+            ring.dropped++;
+            return;
+        }
+
+        if (length > sizeof(can_capture_record_t::raw_data))
+            length = sizeof(can_capture_record_t::raw_data);
+
+        can_capture_record_t &record = ring.records[head & (_ring_size - 1)];
+        record.time_ms = (time_ms != 0) ? time_ms : ((_time_func != nullptr) ? _time_func() : _time);
+        record.object_id = id;
+        record.manager_id = manager_id;
+        record.flags = direction | length;
+        memcpy(record.raw_data, data, length);
+
+        // publish the record
+        ring.head = head + 1;
+    }
+
+    /// @brief Passes all recorded frames to the writer in time order. Should be called from the main loop.
+    /// @param writer Writer of the records
+    /// @return The number of records passed to the writer
+    uint32_t Flush(CANCaptureWriterInterface &writer)
+    {
+        uint32_t written = 0;
+        uint16_t rx_head = _rx_ring.head;
+        uint16_t tx_head = _tx_ring.head;
+
+        while (_rx_ring.tail != rx_head || _tx_ring.tail != tx_head)
+        {
+            ring_t *ring = &_rx_ring;
+            if (_rx_ring.tail == rx_head)
+            {
+                ring = &_tx_ring;
+            }
+            else if (_tx_ring.tail != tx_head)
+            {
+                // merge by time: incoming frame goes first if the times are equal
+                const can_capture_record_t &rx_record = _rx_ring.records[_rx_ring.tail & (_ring_size - 1)];
+                const can_capture_record_t &tx_record = _tx_ring.records[_tx_ring.tail & (_ring_size - 1)];
+                if ((int32_t)(tx_record.time_ms - rx_record.time_ms) < 0)
+                    ring = &_tx_ring;
+            }
+
+            if (!writer.Write(&ring->records[ring->tail & (_ring_size - 1)], 1))
+                break;
+
+            ring->tail = ring->tail + 1;
+            written++;
+        }
+
+        return written;
+    }
+
+    /// @brief Returns the number of records waiting for Flush()
+    /// @return The number of records
+    uint16_t GetNumOfRecords()
+    {
+        return (uint16_t)(_rx_ring.head - _rx_ring.tail) + (uint16_t)(_tx_ring.head - _tx_ring.tail);
+    }
+
+    /// @brief Returns the number of records dropped because of full rings
+    /// @return The number of dropped records
+    uint32_t GetNumOfDroppedRecords()
+    {
+        return _rx_ring.dropped + _tx_ring.dropped;
+    }
+
+private:
+    // single-producer single-consumer ring; head & tail are free-running counters
+    struct ring_t
+    {
+        can_capture_record_t records[_ring_size];
+        volatile uint16_t head = 0;
+        volatile uint16_t tail = 0;
+        uint32_t dropped = 0;
+    };
+
+    ring_t _rx_ring = {};
+    ring_t _tx_ring = {};
+
+    can_time_function_t _time_func = nullptr;
+    volatile uint32_t _time = 0;
+    bool _enabled = true;
+};
@@ -0,0 +1,214 @@
+#include "CANCaptureFile.h"
+
+#if defined(__linux__)
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static_assert(sizeof(can_capture_file_header_t) == 16);
+
+/*******************************************************************************************\
+ *
+ * CANCaptureFileWriter
+ *
+\*******************************************************************************************/
+CANCaptureFileWriter::~CANCaptureFileWriter()
+{
+    Close();
+}
+
+bool CANCaptureFileWriter::Open(const char *path)
+{
+    Close();
+
+    _file = fopen(path, "wb");
+    if (_file == nullptr)
+        return false;
+
+    can_capture_file_header_t header = {};
+    memcpy(header.magic, CAN_CAPTURE_FILE_MAGIC, sizeof(header.magic));
+    header.version = CAN_CAPTURE_FILE_VERSION;
+    header.record_size = sizeof(can_capture_record_t);
+    header.payload_size = CAN_FRAME_MAX_PAYLOAD;
+
+    if (fwrite(&header, sizeof(header), 1, _file) != 1)
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void CANCaptureFileWriter::Close()
+{
+    if (_file == nullptr)
+        return;
+
+    fclose(_file);
+    _file = nullptr;
+    _records_count = 0;
+}
+
+bool CANCaptureFileWriter::IsOpen()
+{
+    return _file != nullptr;
+}
+
+uint32_t CANCaptureFileWriter::GetNumOfRecords()
+{
+    return _records_count;
+}
+
+bool CANCaptureFileWriter::Write(const can_capture_record_t *records, uint16_t count)
+{
+    if (_file == nullptr || records == nullptr)
+        return false;
+
+    if (fwrite(records, sizeof(can_capture_record_t), count, _file) != count)
+        return false;
+
+    _records_count += count;
+    return true;
+}
+
+/*******************************************************************************************\
+ *
+ * CANCaptureFileReader
+ *
+\*******************************************************************************************/
+CANCaptureFileReader::~CANCaptureFileReader()
+{
+    Close();
+}
+
+bool CANCaptureFileReader::Open(const char *path)
+{
+    Close();
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || (size_t)file_stat.st_size < sizeof(can_capture_file_header_t))
+    {
+        close(fd);
+        return false;
+    }
+
+    void *map = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping stays valid after closing the file
+    close(fd);
+    if (map == MAP_FAILED)
+        return false;
+
+    const can_capture_file_header_t *header = (const can_capture_file_header_t *)map;
+    if (memcmp(header->magic, CAN_CAPTURE_FILE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != CAN_CAPTURE_FILE_VERSION ||
+        header->record_size != sizeof(can_capture_record_t) ||
+        header->payload_size != CAN_FRAME_MAX_PAYLOAD)
+    {
+        munmap(map, file_stat.st_size);
+        return false;
+    }
+
+    _map = map;
+    _map_size = file_stat.st_size;
+    // incomplete record at the end of the file (e.g. interrupted writing) is ignored
+    _records_count = (_map_size - sizeof(can_capture_file_header_t)) / sizeof(can_capture_record_t);
+
+    return true;
+}
+
+void CANCaptureFileReader::Close()
+{
+    if (_map == nullptr)
+        return;
+
+    munmap(_map, _map_size);
+    _map = nullptr;
+    _map_size = 0;
+    _records_count = 0;
+}
+
+const can_capture_record_t *CANCaptureFileReader::GetRecords()
+{
+    if (_map == nullptr)
+        return nullptr;
+
+    return (const can_capture_record_t *)((const uint8_t *)_map + sizeof(can_capture_file_header_t));
+}
+
+uint32_t CANCaptureFileReader::GetNumOfRecords()
+{
+    return _records_count;
+}
+
+/*******************************************************************************************\
+ *
+ * Exporters
+ *
+\*******************************************************************************************/
+static uint8_t get_record_length(const can_capture_record_t &record)
+{
+    uint8_t length = record.flags & CAN_CAPTURE_LENGTH_MASK;
+    return (length > sizeof(record.raw_data)) ? sizeof(record.raw_data) : length;
+}
+
+bool can_capture_export_candump(FILE *file, const can_capture_record_t *records, uint32_t count)
+{
+    if (file == nullptr || (records == nullptr && count > 0))
+        return false;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const can_capture_record_t &record = records[i];
+        uint8_t length = get_record_length(record);
+
+        if (fprintf(file, "(%u.%06u) can%u %03X#", record.time_ms / 1000, (record.time_ms % 1000) * 1000,
+                    record.manager_id, record.object_id) < 0)
+            return false;
+
+        for (uint8_t j = 0; j < length; j++)
+            fprintf(file, "%02X", record.raw_data[j]);
+
+        if (fputc('\n', file) == EOF)
+            return false;
+    }
+
+    return true;
+}
+
+bool can_capture_export_asc(FILE *file, const can_capture_record_t *records, uint32_t count)
+{
+    if (file == nullptr || (records == nullptr && count > 0))
+        return false;
+
+    if (fprintf(file, "base hex  timestamps absolute\nno internal events logged\nBegin Triggerblock\n") < 0)
+        return false;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const can_capture_record_t &record = records[i];
+        uint8_t length = get_record_length(record);
+        bool is_tx = (record.flags & CAN_CAPTURE_DIRECTION_MASK) == CAN_CAPTURE_DIRECTION_TX;
+
+        if (fprintf(file, "%4u.%06u %u  %-15X %s   d %u", record.time_ms / 1000, (record.time_ms % 1000) * 1000,
+                    record.manager_id + 1, record.object_id, is_tx ? "Tx" : "Rx", length) < 0)
+            return false;
+
+        for (uint8_t j = 0; j < length; j++)
+            fprintf(file, " %02X", record.raw_data[j]);
+
+        if (fputc('\n', file) == EOF)
+            return false;
+    }
+
+    return fprintf(file, "End TriggerBlock\n") >= 0;
+}
+
+#endif // __linux__
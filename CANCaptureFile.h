@@ -0,0 +1,107 @@
+#pragma once
+
+// Host-side storage of captured frames: binary capture file, memory-mapped reader and text exporters.
+#if defined(__linux__)
+
+#include <stdint.h>
+#include <stdio.h>
+#include "CANCapture.h"
+
+#define CAN_CAPTURE_FILE_MAGIC "PXCANCAP"
+#define CAN_CAPTURE_FILE_VERSION 1
+
+// Header of the capture file. It is followed by fixed size can_capture_record_t records.
+struct __attribute__((__packed__)) can_capture_file_header_t
+{
+    char magic[8];
+    uint16_t version;
+    uint16_t record_size;
+    uint8_t payload_size;
+    uint8_t reserved[3];
+};
+
+/******************************************************************************************
+ ******************************************************************************************/
+/// @brief CANCaptureFileWriter stores captured records to the binary capture file
+class CANCaptureFileWriter : public CANCaptureWriterInterface
+{
+public:
+    CANCaptureFileWriter() = default;
+    virtual ~CANCaptureFileWriter();
+
+    /// @brief Creates the capture file and writes its header. The previously opened file is closed.
+    /// @param path Path to the file
+    /// @return 'true' if the file was created
+    bool Open(const char *path);
+
+    /// @brief Closes the capture file
+    void Close();
+
+    /// @brief Checks if the capture file is opened
+    /// @return 'true' if the file is opened
+    bool IsOpen();
+
+    /// @brief Returns the number of records written to the file
+    /// @return The number of records
+    uint32_t GetNumOfRecords();
+
+    /// @brief Writes records to the file
+    /// @param records Pointer to the records
+    /// @param count The number of records
+    /// @return 'true' if the records were written
+    virtual bool Write(const can_capture_record_t *records, uint16_t count) override;
+
+private:
+    FILE *_file = nullptr;
+    uint32_t _records_count = 0;
+};
+
+/******************************************************************************************
+ ******************************************************************************************/
+/// @brief CANCaptureFileReader maps the capture file into memory, so records are accessed without copying
+class CANCaptureFileReader
+{
+public:
+    CANCaptureFileReader() = default;
+    ~CANCaptureFileReader();
+
+    CANCaptureFileReader(const CANCaptureFileReader &) = delete;
+    CANCaptureFileReader &operator=(const CANCaptureFileReader &) = delete;
+
+    /// @brief Maps the capture file into memory and checks its header. The previously opened file is closed.
+    /// @param path Path to the file
+    /// @return 'true' if the file is a valid capture file
+    bool Open(const char *path);
+
+    /// @brief Unmaps the capture file
+    void Close();
+
+    /// @brief Returns records of the file
+    /// @return Pointer to the first record or nullptr if the file isn't opened
+    const can_capture_record_t *GetRecords();
+
+    /// @brief Returns the number of records in the file
+    /// @return The number of records
+    uint32_t GetNumOfRecords();
+
+private:
+    void *_map = nullptr;
+    size_t _map_size = 0;
+    uint32_t _records_count = 0;
+};
+
+/// @brief Exports records as candump log ("(sec.usec) canN ID#DATA"). The manager ID is the interface number.
+/// @param file Output text file
+/// @param records Pointer to the records
+/// @param count The number of records
+/// @return 'true' if all records were exported
+bool can_capture_export_candump(FILE *file, const can_capture_record_t *records, uint32_t count);
+
+/// @brief Exports records as Vector ASC log. The channel is the manager ID + 1.
+/// @param file Output text file
+/// @param records Pointer to the records
+/// @param count The number of records
+/// @return 'true' if all records were exported
+bool can_capture_export_asc(FILE *file, const can_capture_record_t *records, uint32_t count);
+
+#endif // __linux__
@@ -0,0 +1,424 @@
+#include "CANCaptureIndex.h"
+
+#if defined(__linux__)
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <atomic>
+#include <thread>
+#include "CANBulkDecoder.h"
+
+static_assert(sizeof(can_capture_index_header_t) == 32);
+static_assert(sizeof(can_capture_index_block_t) == 8);
+static_assert(sizeof(can_capture_index_id_t) == 12);
+
+/*******************************************************************************************\
+ *
+ * Index building
+ *
+\*******************************************************************************************/
+bool can_capture_index_build(const can_capture_record_t *records, uint32_t count, const char *index_path, uint32_t block_records)
+{
+    if ((records == nullptr && count > 0) || index_path == nullptr || block_records == 0)
+        return false;
+
+    uint32_t blocks_count = (count + block_records - 1) / block_records;
+    std::vector<can_capture_index_block_t> blocks(blocks_count);
+
+    // postings of every possible ID; the last block of the ID shows whether the block is already listed
+    const uint32_t ids_space = 1u << (8 * sizeof(can_object_id_t));
+    std::vector<std::vector<uint32_t>> postings(ids_space);
+    for (uint32_t block_idx = 0; block_idx < blocks_count; block_idx++)
+    {
+        uint32_t begin = block_idx * block_records;
+        uint32_t end = (count - begin > block_records) ? begin + block_records : count;
+
+        can_capture_index_block_t &block = blocks[block_idx];
+        block.min_time_ms = UINT32_MAX;
+        block.max_time_ms = 0;
+        for (uint32_t i = begin; i < end; i++)
+        {
+            const can_capture_record_t &record = records[i];
+            if (record.time_ms < block.min_time_ms)
+                block.min_time_ms = record.time_ms;
+            if (record.time_ms > block.max_time_ms)
+                block.max_time_ms = record.time_ms;
+
+            std::vector<uint32_t> &id_postings = postings[record.object_id];
+            if (id_postings.empty() || id_postings.back() != block_idx)
+                id_postings.push_back(block_idx);
+        }
+    }
+
+    std::vector<can_capture_index_id_t> ids;
+    uint32_t postings_count = 0;
+    for (uint32_t id = 0; id < ids_space; id++)
+    {
+        if (postings[id].empty())
+            continue;
+
+        can_capture_index_id_t entry = {};
+        entry.id = (can_object_id_t)id;
+        entry.postings_offset = postings_count;
+        entry.postings_count = postings[id].size();
+        ids.push_back(entry);
+        postings_count += entry.postings_count;
+    }
+
+    can_capture_index_header_t header = {};
+    memcpy(header.magic, CAN_CAPTURE_INDEX_MAGIC, sizeof(header.magic));
+    header.version = CAN_CAPTURE_INDEX_VERSION;
+    header.records_count = count;
+    header.block_records = block_records;
+    header.blocks_count = blocks_count;
+    header.ids_count = ids.size();
+    header.postings_count = postings_count;
+
+    FILE *file = fopen(index_path, "wb");
+    if (file == nullptr)
+        return false;
+
+    bool is_ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                 fwrite(blocks.data(), sizeof(can_capture_index_block_t), blocks.size(), file) == blocks.size() &&
+                 fwrite(ids.data(), sizeof(can_capture_index_id_t), ids.size(), file) == ids.size();
+    for (const can_capture_index_id_t &entry : ids)
+    {
+        const std::vector<uint32_t> &id_postings = postings[entry.id];
+        is_ok = is_ok && fwrite(id_postings.data(), sizeof(uint32_t), id_postings.size(), file) == id_postings.size();
+    }
+
+    return (fclose(file) == 0) && is_ok;
+}
+
+/*******************************************************************************************\
+ *
+ * CANCaptureIndexReader
+ *
+\*******************************************************************************************/
+/// @brief Checks the structure of the index: the blocks cover the records, IDs are sorted,
+///        postings of every ID are within the postings and refer to existing blocks in ascending order.
+///        The size of the file must be already checked.
+/// @param header Header of the mapped index
+/// @return 'true' if the index is consistent
+static bool is_index_consistent(const can_capture_index_header_t *header)
+{
+    if (header->blocks_count != ((uint64_t)header->records_count + header->block_records - 1) / header->block_records)
+        return false;
+
+    const can_capture_index_block_t *blocks = (const can_capture_index_block_t *)(header + 1);
+    const can_capture_index_id_t *ids = (const can_capture_index_id_t *)(blocks + header->blocks_count);
+    const uint32_t *postings = (const uint32_t *)(ids + header->ids_count);
+    for (uint32_t i = 0; i < header->ids_count; i++)
+    {
+        const can_capture_index_id_t &entry = ids[i];
+        if ((i > 0 && ids[i - 1].id >= entry.id) ||
+            (uint64_t)entry.postings_offset + entry.postings_count > header->postings_count)
+            return false;
+
+        for (uint32_t p = entry.postings_offset; p < entry.postings_offset + entry.postings_count; p++)
+        {
+            if (postings[p] >= header->blocks_count || (p > entry.postings_offset && postings[p - 1] >= postings[p]))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+CANCaptureIndexReader::~CANCaptureIndexReader()
+{
+    Close();
+}
+
+bool CANCaptureIndexReader::Open(const char *path)
+{
+    Close();
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || (size_t)file_stat.st_size < sizeof(can_capture_index_header_t))
+    {
+        close(fd);
+        return false;
+    }
+
+    void *map = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return false;
+
+    const can_capture_index_header_t *header = (const can_capture_index_header_t *)map;
+    size_t expected_size = sizeof(can_capture_index_header_t) +
+                           (size_t)header->blocks_count * sizeof(can_capture_index_block_t) +
+                           (size_t)header->ids_count * sizeof(can_capture_index_id_t) +
+                           (size_t)header->postings_count * sizeof(uint32_t);
+    if (memcmp(header->magic, CAN_CAPTURE_INDEX_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != CAN_CAPTURE_INDEX_VERSION ||
+        header->block_records == 0 ||
+        (size_t)file_stat.st_size != expected_size ||
+        !is_index_consistent(header))
+    {
+        munmap(map, file_stat.st_size);
+        return false;
+    }
+
+    _map = map;
+    _map_size = file_stat.st_size;
+    _header = header;
+    _blocks = (const can_capture_index_block_t *)(header + 1);
+    _ids = (const can_capture_index_id_t *)(_blocks + header->blocks_count);
+    _postings = (const uint32_t *)(_ids + header->ids_count);
+
+    return true;
+}
+
+void CANCaptureIndexReader::Close()
+{
+    if (_map == nullptr)
+        return;
+
+    munmap(_map, _map_size);
+    _map = nullptr;
+    _map_size = 0;
+    _header = nullptr;
+    _blocks = nullptr;
+    _ids = nullptr;
+    _postings = nullptr;
+}
+
+const can_capture_index_header_t *CANCaptureIndexReader::GetHeader() const
+{
+    return _header;
+}
+
+const can_capture_index_block_t *CANCaptureIndexReader::GetBlocks() const
+{
+    return _blocks;
+}
+
+const uint32_t *CANCaptureIndexReader::FindPostings(can_object_id_t id, uint32_t &count) const
+{
+    count = 0;
+    if (_header == nullptr)
+        return nullptr;
+
+    uint32_t low = 0;
+    uint32_t high = _header->ids_count;
+    while (low < high)
+    {
+        uint32_t mid = low + (high - low) / 2;
+        if (_ids[mid].id == id)
+        {
+            count = _ids[mid].postings_count;
+            return _postings + _ids[mid].postings_offset;
+        }
+
+        if (_ids[mid].id < id)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return nullptr;
+}
+
+/*******************************************************************************************\
+ *
+ * CANCaptureQuery
+ *
+\*******************************************************************************************/
+// Range of tasks of the worker: begin in the low half, end in the high half.
+// The owner takes tasks from the begin, thieves take them from the end.
+struct alignas(64) can_query_worker_range_t
+{
+    std::atomic<uint64_t> range{0};
+};
+
+static inline uint64_t pack_range(uint32_t begin, uint32_t end)
+{
+    return ((uint64_t)end << 32) | begin;
+}
+
+static bool take_first_task(can_query_worker_range_t &worker, uint32_t &task)
+{
+    uint64_t range = worker.range.load(std::memory_order_acquire);
+    while (true)
+    {
+        uint32_t begin = (uint32_t)range;
+        uint32_t end = (uint32_t)(range >> 32);
+        if (begin >= end)
+            return false;
+
+        if (worker.range.compare_exchange_weak(range, pack_range(begin + 1, end), std::memory_order_acq_rel))
+        {
+            task = begin;
+            return true;
+        }
+    }
+}
+
+static bool steal_last_task(can_query_worker_range_t &victim, uint32_t &task)
+{
+    uint64_t range = victim.range.load(std::memory_order_acquire);
+    while (true)
+    {
+        uint32_t begin = (uint32_t)range;
+        uint32_t end = (uint32_t)(range >> 32);
+        if (begin >= end)
+            return false;
+
+        if (victim.range.compare_exchange_weak(range, pack_range(begin, end - 1), std::memory_order_acq_rel))
+        {
+            task = end - 1;
+            return true;
+        }
+    }
+}
+
+CANCaptureQuery::CANCaptureQuery(const can_capture_record_t *records, uint32_t count, const CANCaptureIndexReader &index, uint8_t threads_count)
+    : _records(records), _records_count(count), _index(index), _threads_count(threads_count)
+{
+    if (_threads_count == 0)
+    {
+        unsigned int cores = std::thread::hardware_concurrency();
+        _threads_count = (cores == 0) ? 1 : (cores > UINT8_MAX ? UINT8_MAX : cores);
+    }
+}
+
+bool CANCaptureQuery::IsValid() const
+{
+    const can_capture_index_header_t *header = _index.GetHeader();
+    // every record is in a block and every block starts within the records
+    return header != nullptr && _records != nullptr && header->records_count == _records_count &&
+           (uint64_t)header->blocks_count * header->block_records >= _records_count &&
+           (header->blocks_count == 0 || (uint64_t)(header->blocks_count - 1) * header->block_records < _records_count);
+}
+
+uint32_t CANCaptureQuery::FindById(can_object_id_t id, uint32_t from_time_ms, uint32_t to_time_ms, std::vector<uint32_t> &result)
+{
+    result.clear();
+    if (!IsValid())
+        return 0;
+
+    uint32_t postings_count = 0;
+    const uint32_t *postings = _index.FindPostings(id, postings_count);
+    const can_capture_index_block_t *blocks = _index.GetBlocks();
+
+    std::vector<uint32_t> candidates;
+    for (uint32_t i = 0; i < postings_count; i++)
+    {
+        const can_capture_index_block_t &block = blocks[postings[i]];
+        if (block.max_time_ms >= from_time_ms && block.min_time_ms <= to_time_ms)
+            candidates.push_back(postings[i]);
+    }
+
+    return _Scan(candidates, true, id, from_time_ms, to_time_ms, result);
+}
+
+uint32_t CANCaptureQuery::FindByTime(uint32_t from_time_ms, uint32_t to_time_ms, std::vector<uint32_t> &result)
+{
+    result.clear();
+    if (!IsValid())
+        return 0;
+
+    const can_capture_index_header_t *header = _index.GetHeader();
+    const can_capture_index_block_t *blocks = _index.GetBlocks();
+
+    std::vector<uint32_t> candidates;
+    for (uint32_t i = 0; i < header->blocks_count; i++)
+    {
+        if (blocks[i].max_time_ms >= from_time_ms && blocks[i].min_time_ms <= to_time_ms)
+            candidates.push_back(i);
+    }
+
+    return _Scan(candidates, false, 0, from_time_ms, to_time_ms, result);
+}
+
+uint32_t CANCaptureQuery::_Scan(const std::vector<uint32_t> &blocks, bool by_id, can_object_id_t id,
+                                uint32_t from_time_ms, uint32_t to_time_ms, std::vector<uint32_t> &result)
+{
+    const uint32_t block_records = _index.GetHeader()->block_records;
+    const uint32_t tasks_count = blocks.size();
+    uint8_t workers_count = (tasks_count < _threads_count) ? (tasks_count > 0 ? tasks_count : 1) : _threads_count;
+
+    // initial even split of the tasks
+    std::vector<can_query_worker_range_t> workers(workers_count);
+    for (uint8_t w = 0; w < workers_count; w++)
+    {
+        uint32_t begin = (uint64_t)tasks_count * w / workers_count;
+        uint32_t end = (uint64_t)tasks_count * (w + 1) / workers_count;
+        workers[w].range.store(pack_range(begin, end), std::memory_order_relaxed);
+    }
+
+    // results of every block are kept separately to merge them in block order
+    std::vector<std::vector<uint32_t>> block_results(tasks_count);
+
+    auto scan_block = [&](uint32_t task, std::vector<uint32_t> &indexes) {
+        uint64_t block_begin = (uint64_t)blocks[task] * block_records;
+        if (block_begin >= _records_count)
+            return;
+
+        uint32_t begin = block_begin;
+        uint32_t size = (_records_count - begin > block_records) ? block_records : _records_count - begin;
+        std::vector<uint32_t> &found = block_results[task];
+
+        if (!by_id)
+        {
+            for (uint32_t i = begin; i < begin + size; i++)
+            {
+                if (_records[i].time_ms >= from_time_ms && _records[i].time_ms <= to_time_ms)
+                    found.push_back(i);
+            }
+            return;
+        }
+
+        uint32_t found_count = can_decode_filter_id(_records + begin, size, id, CAN_DECODE_ANY_MANAGER, indexes.data());
+        for (uint32_t i = 0; i < found_count; i++)
+        {
+            const can_capture_record_t &record = _records[begin + indexes[i]];
+            if (record.time_ms >= from_time_ms && record.time_ms <= to_time_ms)
+                found.push_back(begin + indexes[i]);
+        }
+    };
+
+    auto worker_loop = [&](uint8_t worker_idx) {
+        std::vector<uint32_t> indexes(block_records);
+        uint32_t task;
+        while (true)
+        {
+            if (take_first_task(workers[worker_idx], task))
+            {
+                scan_block(task, indexes);
+                continue;
+            }
+
+            bool is_stolen = false;
+            for (uint8_t i = 1; i < workers_count && !is_stolen; i++)
+                is_stolen = steal_last_task(workers[(worker_idx + i) % workers_count], task);
+            if (!is_stolen)
+                break;
+
+            scan_block(task, indexes);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (uint8_t w = 1; w < workers_count; w++)
+        threads.emplace_back(worker_loop, w);
+    worker_loop(0);
+    for (std::thread &thread : threads)
+        thread.join();
+
+    for (const std::vector<uint32_t> &found : block_results)
+        result.insert(result.end(), found.begin(), found.end());
+
+    return result.size();
+}
+
+#endif // __linux__
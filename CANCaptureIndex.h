@@ -0,0 +1,149 @@
+#pragma once
+
+// Host-side sidecar index of capture files and parallel queries by ID and time range.
+#if defined(__linux__)
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "CAN_common.h"
+#include "CANCapture.h"
+
+#define CAN_CAPTURE_INDEX_MAGIC "PXCANIDX"
+#define CAN_CAPTURE_INDEX_VERSION 1
+#define CAN_CAPTURE_INDEX_BLOCK_RECORDS 4096 // default number of records per time block
+
+// Header of the index file. It is followed by blocks, IDs directory and postings.
+struct __attribute__((__packed__)) can_capture_index_header_t
+{
+    char magic[8];
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t records_count; // the number of records in the capture file
+    uint32_t block_records; // the number of records per block: block N starts at record N * block_records
+    uint32_t blocks_count;
+    uint32_t ids_count;
+    uint32_t postings_count;
+};
+
+// Time range of the block
+struct __attribute__((__packed__)) can_capture_index_block_t
+{
+    uint32_t min_time_ms;
+    uint32_t max_time_ms;
+};
+
+// Entry of the IDs directory (sorted by ID): blocks containing the ID are postings[offset, offset + count)
+struct __attribute__((__packed__)) can_capture_index_id_t
+{
+    can_object_id_t id;
+    uint16_t reserved;
+    uint32_t postings_offset;
+    uint32_t postings_count;
+};
+
+/// @brief Builds the index of capture records and saves it to the sidecar file
+/// @param records Records of the capture file (e.g. from CANCaptureFileReader)
+/// @param count The number of records
+/// @param index_path Path to the index file
+/// @param block_records The number of records per time block
+/// @return 'true' if the index was saved
+bool can_capture_index_build(const can_capture_record_t *records, uint32_t count, const char *index_path,
+                             uint32_t block_records = CAN_CAPTURE_INDEX_BLOCK_RECORDS);
+
+/******************************************************************************************
+ ******************************************************************************************/
+/// @brief CANCaptureIndexReader maps the index file into memory
+class CANCaptureIndexReader
+{
+public:
+    CANCaptureIndexReader() = default;
+    ~CANCaptureIndexReader();
+
+    CANCaptureIndexReader(const CANCaptureIndexReader &) = delete;
+    CANCaptureIndexReader &operator=(const CANCaptureIndexReader &) = delete;
+
+    /// @brief Maps the index file into memory and checks its structure. The previously opened file is closed.
+    /// @param path Path to the index file
+    /// @return 'true' if the file is a valid index
+    bool Open(const char *path);
+
+    /// @brief Unmaps the index file
+    void Close();
+
+    /// @brief Returns the header of the index
+    /// @return Pointer to the header or nullptr if the index isn't opened
+    const can_capture_index_header_t *GetHeader() const;
+
+    /// @brief Returns time ranges of blocks
+    /// @return Pointer to the array of GetHeader()->blocks_count blocks
+    const can_capture_index_block_t *GetBlocks() const;
+
+    /// @brief Searches for the blocks containing the ID (binary search in the IDs directory)
+    /// @param id CAN frame ID
+    /// @param count [OUT] The number of blocks
+    /// @return Pointer to the sorted array of block indexes or nullptr if the ID isn't in the capture
+    const uint32_t *FindPostings(can_object_id_t id, uint32_t &count) const;
+
+private:
+    void *_map = nullptr;
+    size_t _map_size = 0;
+    const can_capture_index_header_t *_header = nullptr;
+    const can_capture_index_block_t *_blocks = nullptr;
+    const can_capture_index_id_t *_ids = nullptr;
+    const uint32_t *_postings = nullptr;
+};
+
+/******************************************************************************************
+ ******************************************************************************************/
+/// @brief CANCaptureQuery finds records by ID and time range. Candidate blocks are selected with the index,
+///        then scanned by several threads: every thread takes blocks from its own range and steals from the others
+///        when its range is empty. Results are always sorted by record index.
+class CANCaptureQuery
+{
+public:
+    /// @brief Creates CANCaptureQuery
+    /// @param records Records of the capture file (e.g. from CANCaptureFileReader)
+    /// @param count The number of records
+    /// @param index Opened index of the capture file
+    /// @param threads_count The number of threads; 0 for the number of CPU cores
+    CANCaptureQuery(const can_capture_record_t *records, uint32_t count, const CANCaptureIndexReader &index, uint8_t threads_count = 0);
+
+    /// @brief Checks if the index belongs to the capture
+    /// @return 'true' if the index matches the records
+    bool IsValid() const;
+
+    /// @brief Finds records of the ID within the time range
+    /// @param id CAN frame ID
+    /// @param from_time_ms Start of the time range (inclusive)
+    /// @param to_time_ms End of the time range (inclusive)
+    /// @param result [OUT] Indexes of the found records
+    /// @return The number of found records
+    uint32_t FindById(can_object_id_t id, uint32_t from_time_ms, uint32_t to_time_ms, std::vector<uint32_t> &result);
+
+    /// @brief Finds records within the time range
+    /// @param from_time_ms Start of the time range (inclusive)
+    /// @param to_time_ms End of the time range (inclusive)
+    /// @param result [OUT] Indexes of the found records
+    /// @return The number of found records
+    uint32_t FindByTime(uint32_t from_time_ms, uint32_t to_time_ms, std::vector<uint32_t> &result);
+
+private:
+    const can_capture_record_t *_records;
+    uint32_t _records_count;
+    const CANCaptureIndexReader &_index;
+    uint8_t _threads_count;
+
+    /// @brief Scans candidate blocks in parallel
+    /// @param blocks Indexes of the candidate blocks
+    /// @param by_id 'true' if records are filtered by ID
+    /// @param id CAN frame ID
+    /// @param from_time_ms Start of the time range (inclusive)
+    /// @param to_time_ms End of the time range (inclusive)
+    /// @param result [OUT] Indexes of the found records
+    /// @return The number of found records
+    uint32_t _Scan(const std::vector<uint32_t> &blocks, bool by_id, can_object_id_t id,
+                   uint32_t from_time_ms, uint32_t to_time_ms, std::vector<uint32_t> &result);
+};
+
+#endif // __linux__
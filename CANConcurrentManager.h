@@ -0,0 +1,399 @@
+#pragma once
+
+// Host-side wrapper of CANManager for multi-threaded applications (e.g. Linux gateways).
+#if defined(__linux__)
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include "CAN_common.h"
+#include "CANManager.h"
+
+#define CAN_CONCURRENT_CACHE_LINE_SIZE 64
+
+// Command of other threads executed by the processing thread
+struct can_concurrent_command_t
+{
+    can_object_id_t object_id;
+    bool is_raw;                        // 'true' for SendRawFrame(), 'false' for SendCustomFrame()
+    can_function_id_t function_id;      // SendCustomFrame() only
+    uint8_t data[CAN_FRAME_MAX_PAYLOAD + 1]; // SendRawFrame(): raw data including function ID
+    uint8_t data_length;
+};
+
+/******************************************************************************************
+ ******************************************************************************************/
+/// @brief CANConcurrentManager allows several threads to use CANManager without locks.
+///        CANManager and all its CANObjects are owned by the processing thread: only Process() touches them (single writer).
+///        Incoming frames of any thread go through the lock-free bounded multi-producer queue.
+///        Outgoing frames of other threads are staged in per-thread single-producer queues and are sent by Process(),
+///        so the sending function of CANManager is always called from the processing thread.
+///        A thread takes its queue on the first send and releases it when it exits (or calls DetachThread()),
+///        so any number of threads can send over time, up to _max_tx_threads at once.
+///        Nothing on the per-frame path takes a mutex; full queues reject frames and count them.
+/// @tparam _rx_queue_size — The number of incoming frames in the queue, power of 2
+/// @tparam _max_tx_threads — The maximum number of threads which send frames
+/// @tparam _tx_queue_size — The number of outgoing frames in the queue of every thread, power of 2
+template <uint16_t _rx_queue_size = 256, uint8_t _max_tx_threads = 4, uint16_t _tx_queue_size = 32>
+class CANConcurrentManager
+{
+    static_assert(_rx_queue_size > 0 && (_rx_queue_size & (_rx_queue_size - 1)) == 0);
+    static_assert(_tx_queue_size > 0 && (_tx_queue_size & (_tx_queue_size - 1)) == 0);
+    static_assert(_max_tx_threads > 0);
+public:
+    /// @brief Creates CANConcurrentManager
+    /// @param can_manager CANManager to wrap. It should be configured before the threads start and
+    ///                    should not be used directly after that.
+    CANConcurrentManager(CANManagerInterface &can_manager)
+        : _can_manager(can_manager)
+    {
+        for (uint16_t i = 0; i < _rx_queue_size; i++)
+            _rx_queue[i].sequence.store(i, std::memory_order_relaxed);
+    };
+
+    ~CANConcurrentManager() = default;
+
+    CANConcurrentManager(const CANConcurrentManager &) = delete;
+    CANConcurrentManager &operator=(const CANConcurrentManager &) = delete;
+
+    /// @brief Returns wrapped CANManager. Use it for configuration before the threads start only.
+    /// @return Wrapped CANManager
+    CANManagerInterface &GetManager()
+    {
+        return _can_manager;
+    }
+
+    /// @brief Stores incoming CAN frame in the queue. It can be called from any thread.
+    /// @param id CANObject ID from the CAN frame
+    /// @param data Pointer to the data array
+    /// @param length Data length
+    /// @return 'true' if the frame was queued, 'false' if the data is incorrect or the queue is full
+    bool IncomingCANFrame(can_object_id_t id, const uint8_t *data, uint8_t length)
+    {
+        if (data == nullptr || length == 0 || length > CAN_FRAME_MAX_PAYLOAD + 1)
+            return false;
+
+        uint32_t pos = _rx_enqueue_pos.load(std::memory_order_relaxed);
+        rx_cell_t *cell;
+        while (true)
+        {
+            cell = &_rx_queue[pos & (_rx_queue_size - 1)];
+            int32_t diff = (int32_t)(cell->sequence.load(std::memory_order_acquire) - pos);
+            if (diff == 0)
+            {
+                if (_rx_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                _rx_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            else
+            {
+                pos = _rx_enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->frame.object_id = id;
+        memcpy(cell->frame.raw_data, data, length);
+        cell->frame.raw_data_length = length;
+        cell->frame.time_ms = 0;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /// @brief Queues custom CAN frame of the registered CANObject. It can be called from any thread.
+    ///        The frame is generated and sent by the next Process() call.
+    /// @param id ID of the registered CANObject
+    /// @param function_id CAN function ID
+    /// @param data Frame data to send in CAN frame
+    /// @param data_length Frame data length
+    /// @return 'true' if the frame was queued, 'false' if the data is too long or the queue is full
+    bool SendCustomFrame(can_object_id_t id, can_function_id_t function_id, const uint8_t *data = nullptr, uint8_t data_length = 0)
+    {
+        if (data_length > CAN_FRAME_MAX_PAYLOAD || (data == nullptr && data_length > 0))
+            return false;
+
+        can_concurrent_command_t command = {};
+        command.object_id = id;
+        command.is_raw = false;
+        command.function_id = function_id;
+        if (data_length > 0)
+            memcpy(command.data, data, data_length);
+        command.data_length = data_length;
+
+        return _PushCommand(command);
+    }
+
+    /// @brief Queues raw CAN frame. It can be called from any thread.
+    /// @param id CAN frame ID
+    /// @param data Frame data including function ID
+    /// @param length Frame data length including function ID
+    /// @return 'true' if the frame was queued, 'false' if the data is incorrect or the queue is full
+    bool SendRawFrame(can_object_id_t id, const uint8_t *data, uint8_t length)
+    {
+        if (data == nullptr || length == 0 || length > CAN_FRAME_MAX_PAYLOAD + 1)
+            return false;
+
+        can_concurrent_command_t command = {};
+        command.object_id = id;
+        command.is_raw = true;
+        memcpy(command.data, data, length);
+        command.data_length = length;
+
+        return _PushCommand(command);
+    }
+
+    /// @brief Releases the outgoing queue of the current thread. Frames queued before are still sent by Process().
+    ///        The queue is released automatically when the thread exits: call it explicitly
+    ///        if the thread keeps running after the CANConcurrentManager is destroyed or stops sending for good.
+    void DetachThread()
+    {
+        tx_slot_t *slot = _FindThreadSlot(std::this_thread::get_id());
+        if (slot == nullptr)
+            return;
+
+        _GetThreadState().Remove(slot);
+        slot->releasing.store(true, std::memory_order_release);
+    }
+
+    /// @brief Performs processing: moves queued incoming frames to CANManager, sends queued outgoing frames
+    ///        and calls Process() of CANManager. It must always be called from the same (processing) thread.
+    /// @param time Current time
+    void Process(uint32_t time)
+    {
+        _DrainIncomingFrames();
+        _ExecuteCommands();
+
+        _can_manager.Process(time);
+    }
+
+    /// @brief Returns the number of incoming frames rejected because of the full queue
+    /// @return The number of frames
+    uint32_t GetNumOfDroppedIncomingFrames()
+    {
+        return _rx_dropped.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Returns the number of outgoing frames rejected because of the full queues, the lack of free thread slots
+    ///        or unregistered CANObjects
+    /// @return The number of frames
+    uint32_t GetNumOfDroppedOutgoingFrames()
+    {
+        return _tx_dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    // cell of the bounded multi-producer queue: the sequence tells which lap of the ring the cell belongs to
+    struct rx_cell_t
+    {
+        std::atomic<uint32_t> sequence;
+        can_frame_t frame;
+    };
+
+    // single-producer single-consumer queue of the sending thread
+    struct alignas(CAN_CONCURRENT_CACHE_LINE_SIZE) tx_slot_t
+    {
+        std::atomic<std::thread::id> owner{std::thread::id()};
+        std::atomic<bool> releasing{false}; // set by the owner thread, the processing thread frees the slot when it is drained
+        tx_slot_t *next_of_thread = nullptr; // owner thread only: the list of the slots taken by the thread
+        alignas(CAN_CONCURRENT_CACHE_LINE_SIZE) std::atomic<uint32_t> head{0}; // written by the owner thread
+        alignas(CAN_CONCURRENT_CACHE_LINE_SIZE) std::atomic<uint32_t> tail{0}; // written by the processing thread
+        can_concurrent_command_t commands[_tx_queue_size];
+    };
+
+    // slots taken by the thread, released when the thread exits
+    struct tx_thread_state_t
+    {
+        const void *cached_owner = nullptr; // the last used CANConcurrentManager
+        tx_slot_t *cached_slot = nullptr;
+        tx_slot_t *slots = nullptr;
+
+        ~tx_thread_state_t()
+        {
+            tx_slot_t *slot = slots;
+            while (slot != nullptr)
+            {
+                // the slot can be taken by another thread as soon as it is released
+                tx_slot_t *next = slot->next_of_thread;
+                slot->releasing.store(true, std::memory_order_release);
+                slot = next;
+            }
+        }
+
+        void Add(tx_slot_t *slot)
+        {
+            slot->next_of_thread = slots;
+            slots = slot;
+        }
+
+        void Remove(tx_slot_t *slot)
+        {
+            tx_slot_t **link = &slots;
+            while (*link != nullptr && *link != slot)
+                link = &(*link)->next_of_thread;
+            if (*link != nullptr)
+                *link = slot->next_of_thread;
+            if (cached_slot == slot)
+                cached_slot = nullptr;
+        }
+    };
+
+    CANManagerInterface &_can_manager;
+
+    rx_cell_t _rx_queue[_rx_queue_size];
+    alignas(CAN_CONCURRENT_CACHE_LINE_SIZE) std::atomic<uint32_t> _rx_enqueue_pos{0};
+    alignas(CAN_CONCURRENT_CACHE_LINE_SIZE) uint32_t _rx_dequeue_pos = 0; // processing thread only
+    std::atomic<uint32_t> _rx_dropped{0};
+
+    tx_slot_t _tx_slots[_max_tx_threads];
+    std::atomic<uint32_t> _tx_dropped{0};
+
+    /// @brief Returns the state of the current thread
+    /// @return Thread state
+    static tx_thread_state_t &_GetThreadState()
+    {
+        static thread_local tx_thread_state_t state;
+        return state;
+    }
+
+    /// @brief Finds the queue taken by the thread
+    /// @param thread_id Thread ID
+    /// @return Pointer to the queue or nullptr if the thread has no queue
+    tx_slot_t *_FindThreadSlot(std::thread::id thread_id)
+    {
+        // released queues are skipped: IDs of exited threads can be reused
+        for (uint8_t i = 0; i < _max_tx_threads; i++)
+        {
+            if (_tx_slots[i].owner.load(std::memory_order_acquire) == thread_id &&
+                !_tx_slots[i].releasing.load(std::memory_order_relaxed))
+                return &_tx_slots[i];
+        }
+        return nullptr;
+    }
+
+    /// @brief Returns the queue of the current thread, the free queue is taken on the first call
+    /// @return Pointer to the queue or nullptr if all queues are taken by other threads
+    tx_slot_t *_GetThreadSlot()
+    {
+        // the last used slot is cached per thread, so the search happens once per thread & CANConcurrentManager
+        tx_thread_state_t &state = _GetThreadState();
+        std::thread::id this_thread = std::this_thread::get_id();
+        if (state.cached_owner == this && state.cached_slot != nullptr &&
+            state.cached_slot->owner.load(std::memory_order_relaxed) == this_thread)
+            return state.cached_slot;
+
+        tx_slot_t *slot = _FindThreadSlot(this_thread);
+        for (uint8_t i = 0; i < _max_tx_threads && slot == nullptr; i++)
+        {
+            std::thread::id free_id;
+            if (_tx_slots[i].owner.compare_exchange_strong(free_id, this_thread, std::memory_order_acq_rel))
+            {
+                slot = &_tx_slots[i];
+                state.Add(slot);
+            }
+        }
+
+        if (slot != nullptr)
+        {
+            state.cached_owner = this;
+            state.cached_slot = slot;
+        }
+        return slot;
+    }
+
+    /// @brief Stores the command in the queue of the current thread
+    /// @param command Command to store
+    /// @return 'true' if the command was stored
+    bool _PushCommand(const can_concurrent_command_t &command)
+    {
+        tx_slot_t *slot = _GetThreadSlot();
+        if (slot == nullptr)
+        {
+            _tx_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        uint32_t head = slot->head.load(std::memory_order_relaxed);
+        if (head - slot->tail.load(std::memory_order_acquire) >= _tx_queue_size)
+        {
+            _tx_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        slot->commands[head & (_tx_queue_size - 1)] = command;
+        slot->head.store(head + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /// @brief Moves queued incoming frames to the buffer of CANManager while it has free space
+    void _DrainIncomingFrames()
+    {
+        can_frame_t frames[32];
+        uint8_t free_slots = _can_manager.GetBufferSize() - _can_manager.GetNumOfFramesInBuffer();
+        while (free_slots > 0)
+        {
+            uint8_t count = 0;
+            while (count < free_slots && count < 32)
+            {
+                rx_cell_t &cell = _rx_queue[_rx_dequeue_pos & (_rx_queue_size - 1)];
+                if (cell.sequence.load(std::memory_order_acquire) != _rx_dequeue_pos + 1)
+                    break;
+
+                frames[count++] = cell.frame;
+                cell.sequence.store(_rx_dequeue_pos + _rx_queue_size, std::memory_order_release);
+                _rx_dequeue_pos++;
+            }
+
+            if (count == 0)
+                break;
+
+            // rejected frames (unknown IDs, wrong length) are dropped as CANManager does
+            _can_manager.IncomingCANFrames(frames, count);
+            free_slots -= count;
+        }
+    }
+
+    /// @brief Sends queued outgoing frames of all threads
+    void _ExecuteCommands()
+    {
+        for (uint8_t i = 0; i < _max_tx_threads; i++)
+        {
+            tx_slot_t &slot = _tx_slots[i];
+            uint32_t tail = slot.tail.load(std::memory_order_relaxed);
+            uint32_t head = slot.head.load(std::memory_order_acquire);
+            for (; tail != head; tail++)
+            {
+                can_concurrent_command_t &command = slot.commands[tail & (_tx_queue_size - 1)];
+                if (command.is_raw)
+                {
+                    _can_manager.SendRawFrame(command.object_id, command.data, command.data_length);
+                    continue;
+                }
+
+                CANObjectInterface *can_object = _can_manager.GetCanObject(command.object_id);
+                if (can_object == nullptr)
+                {
+                    _tx_dropped.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+                _can_manager.SendCustomFrame(*can_object, command.function_id,
+                                             command.data_length > 0 ? command.data : nullptr, command.data_length);
+            }
+            slot.tail.store(tail, std::memory_order_release);
+
+            // the slot of the exited (or detached) thread is freed once its queue is drained
+            if (slot.releasing.load(std::memory_order_acquire) && slot.head.load(std::memory_order_acquire) == tail)
+            {
+                slot.releasing.store(false, std::memory_order_relaxed);
+                slot.owner.store(std::thread::id(), std::memory_order_release);
+            }
+        }
+    }
+};
+
+#endif // __linux__
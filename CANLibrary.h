@@ -4,7 +4,23 @@
 #include "pix_utils.h"
 
 #include "CAN_common.h"
+#include "CAN_wire.h"
+#include "CANTxBudget.h"
+#include "CANProfiler.h"
+#include "CANLivenessMonitor.h"
+#include "CANObjectTable.h"
 #include "CANManager.h"
+#include "CANMirrorObject.h"
+#include "CANSignalObject.h"
+#include "CANProfilerObject.h"
+#include "CANBridge.h"
+#include "CANCapture.h"
+#include "CANCaptureFile.h"
+#include "CANReplay.h"
+#include "CANBulkDecoder.h"
+#include "CANCaptureIndex.h"
+#include "CANConcurrentManager.h"
+#include "CANShardedRuntime.h"
 #include "CAN_common_block.h"
 
 #endif // CANLIBRARY_H
\ No newline at end of file
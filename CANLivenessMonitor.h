@@ -0,0 +1,422 @@
+#pragma once
+
+#include <stdint.h>
+#include "CAN_common.h"
+
+using can_liveness_handler_t = void (*)(can_object_id_t id, uint32_t silence_ms, void *context);
+
+/******************************************************************************************
+ *
+ ******************************************************************************************/
+class CANLivenessMonitorInterface
+{
+public:
+    virtual ~CANLivenessMonitorInterface() = default;
+
+    /// @brief Starts monitoring of the remote ID or changes its timeout. The silence is counted from the current time.
+    ///        Configuration should be done before the frames come (Observe() may be called from ISR).
+    /// @param id Remote ID (e.g. ID of BlockInfo or BlockHealth object of the remote node)
+    /// @param timeout_ms The maximum silence in milliseconds, at least 1
+    /// @return 'true' if the ID is monitored, 'false' if there is no free space
+    virtual bool Watch(can_object_id_t id, uint32_t timeout_ms) = 0;
+
+    /// @brief Stops monitoring of the remote ID
+    /// @param id Remote ID
+    /// @return 'true' if the ID was monitored
+    virtual bool Unwatch(can_object_id_t id) = 0;
+
+    /// @brief Registers the frame of the remote ID at the time of the last Process() call. It can be called from ISR.
+    /// @param id ID of the frame
+    virtual void Observe(can_object_id_t id) = 0;
+
+    /// @brief Registers the frame of the remote ID. It can be called from ISR.
+    /// @param id ID of the frame
+    /// @param time Time of the frame
+    virtual void Observe(can_object_id_t id, uint32_t time) = 0;
+
+    /// @brief Handles the next expired ID: calls the expiry handler and returns the ID.
+    ///        The ID expires once per silence period.
+    /// @param time Current time
+    /// @param expired_id [OUT] Expired ID
+    /// @return 'true' if the ID expired, 'false' if there are no more expired IDs for now
+    virtual bool ProcessNext(uint32_t time, can_object_id_t &expired_id) = 0;
+
+    /// @brief Handles all expired IDs
+    /// @param time Current time
+    /// @return The number of expired IDs
+    virtual uint16_t Process(uint32_t time) = 0;
+
+    /// @brief Sets the handler of expired IDs
+    /// @param handler Pointer to the handler. nullptr removes the handler.
+    /// @param context User data passed to the handler
+    virtual void SetExpiryHandler(can_liveness_handler_t handler, void *context = nullptr) = 0;
+
+    /// @brief Enables error events about expired IDs: CANManager sends CAN_FUNC_EVENT_ERROR frame
+    ///        { ERROR_SECTION_CAN_MANAGER, ERROR_CODE_MANAGER_REMOTE_NODE_TIMEOUT, expired ID[2] } with the reporter ID.
+    /// @param enabled 'true' to send error events
+    /// @param reporter_id ID of the local object which reports the errors (e.g. BlockError object)
+    virtual void SetErrorEvent(bool enabled, can_object_id_t reporter_id = CAN_SYSTEM_ID_BROADCAST) = 0;
+
+    /// @brief Returns the settings of error events
+    /// @param reporter_id [OUT] ID of the local object which reports the errors
+    /// @return 'true' if error events are enabled
+    virtual bool GetErrorEvent(can_object_id_t &reporter_id) = 0;
+
+    /// @brief Checks whether the remote ID was observed during its timeout (at the time of the last Process() call)
+    /// @param id Remote ID
+    /// @return 'true' if the ID is monitored and alive
+    virtual bool IsAlive(can_object_id_t id) = 0;
+
+    /// @brief Returns the time of the last frame of the remote ID
+    /// @param id Remote ID
+    /// @param time [OUT] Time of the last frame (or of the start of monitoring)
+    /// @return 'true' if the ID is monitored
+    virtual bool GetLastSeen(can_object_id_t id, uint32_t &time) = 0;
+
+    /// @brief Returns the number of monitored IDs
+    /// @return The number of IDs
+    virtual uint16_t GetNumOfWatchedNodes() = 0;
+
+    /// @brief Returns the number of expired IDs which weren't observed since the expiry
+    /// @return The number of IDs
+    virtual uint16_t GetNumOfExpiredNodes() = 0;
+};
+
+/******************************************************************************************
+ ******************************************************************************************/
+/// @brief CANLivenessMonitor detects remote nodes which went quiet. Every monitored ID has its timeout;
+///        any frame of the ID resets it. Deadlines are kept in the min-heap with lazy rekeying:
+///        Observe() only stores the time of the frame, the heap is fixed when the deadline comes.
+///        So the frame costs a binary search and the tick costs one heap check while nothing expires,
+///        and the expiry costs O(log n).
+/// @tparam _max_nodes — The maximum number of monitored IDs
+template <uint16_t _max_nodes = 32>
+class CANLivenessMonitor : public CANLivenessMonitorInterface
+{
+    static_assert(_max_nodes > 0); // 0 IDs is not allowed
+public:
+    CANLivenessMonitor() = default;
+
+    CANLivenessMonitor(can_liveness_handler_t handler, void *context = nullptr)
+        : _handler(handler), _handler_context(context){};
+
+    /// @brief Starts monitoring of the remote ID or changes its timeout. The silence is counted from the current time.
+    ///        Configuration should be done before the frames come (Observe() may be called from ISR).
+    /// @param id Remote ID (e.g. ID of BlockInfo or BlockHealth object of the remote node)
+    /// @param timeout_ms The maximum silence in milliseconds, at least 1
+    /// @return 'true' if the ID is monitored, 'false' if there is no free space
+    virtual bool Watch(can_object_id_t id, uint32_t timeout_ms) override
+    {
+        if (timeout_ms == 0)
+            timeout_ms = 1;
+
+        uint16_t pos = _LowerBound(id);
+        if (pos < _count && _nodes[pos].id == id)
+        {
+            node_t &node = _nodes[pos];
+            node.timeout = timeout_ms;
+            node.last_seen = _time;
+            node.deadline = _time + timeout_ms;
+            _SiftUp(node.heap_pos);
+            _SiftDown(node.heap_pos);
+            return true;
+        }
+
+        if (_count >= _max_nodes)
+            return false;
+
+        // nodes are sorted by ID: shift the tail and fix heap references
+        for (uint16_t i = _count; i > pos; i--)
+        {
+            _nodes[i] = _nodes[i - 1];
+            _heap[_nodes[i].heap_pos] = i;
+        }
+        _count++;
+
+        node_t &node = _nodes[pos];
+        node.id = id;
+        node.timeout = timeout_ms;
+        node.last_seen = _time;
+        node.deadline = _time + timeout_ms;
+        node.expired = false;
+        node.heap_pos = _count - 1;
+        _heap[node.heap_pos] = pos;
+        _SiftUp(node.heap_pos);
+
+        return true;
+    }
+
+    /// @brief Stops monitoring of the remote ID
+    /// @param id Remote ID
+    /// @return 'true' if the ID was monitored
+    virtual bool Unwatch(can_object_id_t id) override
+    {
+        int16_t pos = _FindNode(id);
+        if (pos < 0)
+            return false;
+
+        if (_nodes[pos].expired)
+            _expired_count--;
+
+        // the last heap item takes the place of the removed one
+        uint16_t heap_pos = _nodes[pos].heap_pos;
+        _HeapSwap(heap_pos, _count - 1);
+        _count--;
+        if (heap_pos < _count)
+        {
+            _SiftUp(heap_pos);
+            _SiftDown(heap_pos);
+        }
+
+        for (uint16_t i = pos; i < _count; i++)
+        {
+            _nodes[i] = _nodes[i + 1];
+            _heap[_nodes[i].heap_pos] = i;
+        }
+
+        return true;
+    }
+
+    /// @brief Registers the frame of the remote ID at the time of the last Process() call. It can be called from ISR.
+    /// @param id ID of the frame
+    virtual void Observe(can_object_id_t id) override
+    {
+        Observe(id, _time);
+    }
+
+    /// @brief Registers the frame of the remote ID. It can be called from ISR.
+    /// @param id ID of the frame
+    /// @param time Time of the frame
+    virtual void Observe(can_object_id_t id, uint32_t time) override
+    {
+        int16_t pos = _FindNode(id);
+        if (pos >= 0)
+            _nodes[pos].last_seen = time;
+    }
+
+    /// @brief Handles the next expired ID: calls the expiry handler and returns the ID.
+    ///        The ID expires once per silence period.
+    /// @param time Current time
+    /// @param expired_id [OUT] Expired ID
+    /// @return 'true' if the ID expired, 'false' if there are no more expired IDs for now
+    virtual bool ProcessNext(uint32_t time, can_object_id_t &expired_id) override
+    {
+        _time = time;
+
+        while (_count > 0)
+        {
+            node_t &node = _nodes[_heap[0]];
+            if ((int32_t)(node.deadline - time) > 0)
+                return false;
+
+            // the frame came after the deadline was set: the real deadline is later
+            int32_t silence = (int32_t)(time - node.last_seen);
+            if (silence < (int32_t)node.timeout)
+            {
+                if (node.expired)
+                {
+                    node.expired = false;
+                    _expired_count--;
+                }
+                node.deadline = node.last_seen + node.timeout;
+                _SiftDown(0);
+                continue;
+            }
+
+            // the silent node is checked again a timeout later to notice its recovery
+            node.deadline = time + node.timeout;
+            _SiftDown(0);
+            if (node.expired)
+                continue;
+
+            node.expired = true;
+            _expired_count++;
+            expired_id = node.id;
+            if (_handler != nullptr)
+                _handler(node.id, (uint32_t)silence, _handler_context);
+
+            return true;
+        }
+
+        return false;
+    }
+
+    /// @brief Handles all expired IDs
+    /// @param time Current time
+    /// @return The number of expired IDs
+    virtual uint16_t Process(uint32_t time) override
+    {
+        uint16_t expired = 0;
+        can_object_id_t expired_id;
+        while (ProcessNext(time, expired_id))
+            expired++;
+
+        return expired;
+    }
+
+    /// @brief Sets the handler of expired IDs
+    /// @param handler Pointer to the handler. nullptr removes the handler.
+    /// @param context User data passed to the handler
+    virtual void SetExpiryHandler(can_liveness_handler_t handler, void *context = nullptr) override
+    {
+        _handler = handler;
+        _handler_context = context;
+    }
+
+    /// @brief Enables error events about expired IDs: CANManager sends CAN_FUNC_EVENT_ERROR frame
+    ///        { ERROR_SECTION_CAN_MANAGER, ERROR_CODE_MANAGER_REMOTE_NODE_TIMEOUT, expired ID[2] } with the reporter ID.
+    /// @param enabled 'true' to send error events
+    /// @param reporter_id ID of the local object which reports the errors (e.g. BlockError object)
+    virtual void SetErrorEvent(bool enabled, can_object_id_t reporter_id = CAN_SYSTEM_ID_BROADCAST) override
+    {
+        _error_event = enabled;
+        _reporter_id = reporter_id;
+    }
+
+    /// @brief Returns the settings of error events
+    /// @param reporter_id [OUT] ID of the local object which reports the errors
+    /// @return 'true' if error events are enabled
+    virtual bool GetErrorEvent(can_object_id_t &reporter_id) override
+    {
+        reporter_id = _reporter_id;
+        return _error_event;
+    }
+
+    /// @brief Checks whether the remote ID was observed during its timeout (at the time of the last Process() call)
+    /// @param id Remote ID
+    /// @return 'true' if the ID is monitored and alive
+    virtual bool IsAlive(can_object_id_t id) override
+    {
+        int16_t pos = _FindNode(id);
+        return pos >= 0 && (int32_t)(_time - _nodes[pos].last_seen) < (int32_t)_nodes[pos].timeout;
+    }
+
+    /// @brief Returns the time of the last frame of the remote ID
+    /// @param id Remote ID
+    /// @param time [OUT] Time of the last frame (or of the start of monitoring)
+    /// @return 'true' if the ID is monitored
+    virtual bool GetLastSeen(can_object_id_t id, uint32_t &time) override
+    {
+        int16_t pos = _FindNode(id);
+        if (pos < 0)
+            return false;
+
+        time = _nodes[pos].last_seen;
+        return true;
+    }
+
+    /// @brief Returns the number of monitored IDs
+    /// @return The number of IDs
+    virtual uint16_t GetNumOfWatchedNodes() override
+    {
+        return _count;
+    }
+
+    /// @brief Returns the number of expired IDs which weren't observed since the expiry
+    /// @return The number of IDs
+    virtual uint16_t GetNumOfExpiredNodes() override
+    {
+        return _expired_count;
+    }
+
+private:
+    struct node_t
+    {
+        can_object_id_t id = 0;
+        uint16_t heap_pos = 0; // position of the node in the heap
+        uint32_t timeout = 0;
+        volatile uint32_t last_seen = 0;
+        uint32_t deadline = 0; // heap key: it may be earlier than the real deadline (lazy rekeying)
+        bool expired = false;
+    };
+
+    node_t _nodes[_max_nodes] = {}; // sorted by ID
+    uint16_t _heap[_max_nodes] = {0}; // indexes of the nodes, min-heap by deadline
+    uint16_t _count = 0;
+    uint16_t _expired_count = 0;
+    uint32_t _time = 0;
+
+    can_liveness_handler_t _handler = nullptr;
+    void *_handler_context = nullptr;
+    bool _error_event = false;
+    can_object_id_t _reporter_id = CAN_SYSTEM_ID_BROADCAST;
+
+    /// @brief Returns the position of the first node with ID not less than the specified one
+    /// @param id ID to search
+    /// @return Position in the array of nodes
+    uint16_t _LowerBound(can_object_id_t id)
+    {
+        uint16_t low = 0;
+        uint16_t high = _count;
+        while (low < high)
+        {
+            uint16_t mid = low + (high - low) / 2;
+            if (_nodes[mid].id < id)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+        return low;
+    }
+
+    /// @brief Searches for the node (binary search)
+    /// @param id ID to search
+    /// @return Position of the node or -1 if it isn't monitored
+    int16_t _FindNode(can_object_id_t id)
+    {
+        uint16_t pos = _LowerBound(id);
+        return (pos < _count && _nodes[pos].id == id) ? pos : -1;
+    }
+
+    /// @brief Checks whether the deadline of the heap item 'a' is earlier than the deadline of 'b'
+    bool _HeapLess(uint16_t a, uint16_t b)
+    {
+        return (int32_t)(_nodes[_heap[a]].deadline - _nodes[_heap[b]].deadline) < 0;
+    }
+
+    /// @brief Swaps heap items and updates references of their nodes
+    void _HeapSwap(uint16_t a, uint16_t b)
+    {
+        uint16_t node = _heap[a];
+        _heap[a] = _heap[b];
+        _heap[b] = node;
+        _nodes[_heap[a]].heap_pos = a;
+        _nodes[_heap[b]].heap_pos = b;
+    }
+
+    /// @brief Moves the heap item up to its place
+    /// @param pos Position of the item
+    void _SiftUp(uint16_t pos)
+    {
+        while (pos > 0)
+        {
+            uint16_t parent = (pos - 1) / 2;
+            if (!_HeapLess(pos, parent))
+                break;
+
+            _HeapSwap(pos, parent);
+            pos = parent;
+        }
+    }
+
+    /// @brief Moves the heap item down to its place
+    /// @param pos Position of the item
+    void _SiftDown(uint16_t pos)
+    {
+        while (true)
+        {
+            uint16_t smallest = pos;
+            uint16_t left = 2 * pos + 1;
+            uint16_t right = left + 1;
+            if (left < _count && _HeapLess(left, smallest))
+                smallest = left;
+            if (right < _count && _HeapLess(right, smallest))
+                smallest = right;
+            if (smallest == pos)
+                break;
+
+            _HeapSwap(pos, smallest);
+            pos = smallest;
+        }
+    }
+};
@@ -5,6 +5,38 @@
 #include <cassert>
 #include "CAN_common.h"
 #include "CANObject.h"
+#include "CANObjectTable.h"
+#include "CANMirrorObject.h"
+#include "CANCapture.h"
+#include "CANTxBudget.h"
+#include "CANProfiler.h"
+#include "CANLivenessMonitor.h"
+
+#ifndef CAN_RX_ERROR_QUEUE_SIZE
+#define CAN_RX_ERROR_QUEUE_SIZE 4 // the number of error answers to rejected incoming frames waiting for Process(), power of 2
+#endif
+
+/******************************************************************************************
+ *
+ ******************************************************************************************/
+/// @brief Receiver of incoming frames which should leave the CANManager (e.g. a bridge to other CAN buses)
+class CANFrameForwarderInterface
+{
+public:
+    virtual ~CANFrameForwarderInterface() = default;
+
+    /// @brief Checks whether incoming frame should be forwarded. It is called from IncomingCANFrame(), so it should be fast.
+    /// @param manager_id ID of the CANManager which received the frame
+    /// @param id CANObject ID from the CAN frame
+    /// @param function_id CAN function ID from the CAN frame
+    /// @return 'true' if the frame should be stored in the buffer and forwarded later
+    virtual bool IsForwarded(uint8_t manager_id, can_object_id_t id, can_function_id_t function_id) = 0;
+
+    /// @brief Forwards incoming frame. It is called from Process() with the frame from the incoming buffer.
+    /// @param manager_id ID of the CANManager which received the frame
+    /// @param can_frame Incoming CAN frame. It should not be changed.
+    virtual void ForwardFrame(uint8_t manager_id, const can_frame_t &can_frame) = 0;
+};
 
 /******************************************************************************************
  *
@@ -19,6 +51,17 @@ public:
     /// @return 'true' if registration was successful, 'false' if not
     virtual bool RegisterObject(CANObjectInterface &can_object) = 0;
 
+    /// @brief Registers mirror object of the remote CANObject. Passing timer and event frames of the remote object will update it.
+    /// @param mirror_object Mirror object for registration
+    /// @return 'true' if registration was successful, 'false' if not
+    virtual bool RegisterMirrorObject(CANMirrorObjectInterface &mirror_object) = 0;
+
+    /// @brief Searches for the mirror object among the registered ones
+    /// @param id ID of the remote CANObject
+    /// @return 'pointer to CANMirrorObjectInterface' if this mirror object is registered,
+    ///         'nullptr' if it was not found.
+    virtual CANMirrorObjectInterface *GetMirrorObject(can_object_id_t id) = 0;
+
     /// @brief Returns the number of CANObjects, which are registered in CANManager
     /// @return The number of CANObjects, which are registered in CANManager
     virtual uint8_t GetObjectsCount() = 0;
@@ -38,14 +81,128 @@ public:
     /// @return The number of CAN frames stored in the buffer.
     virtual uint8_t GetNumOfFramesInBuffer() = 0;
 
+    /// @brief Returns the capacity of the incoming frames buffer
+    /// @return The maximum number of CAN frames stored in the buffer
+    virtual uint8_t GetBufferSize() = 0;
+
+    /// @brief Spreads timer phases of all registered CANObjects with enabled timers evenly across their periods.
+    ///        It overrides the default ID-based phases, so it should be called after all objects are registered and configured.
+    virtual void SpreadTimerPhases() = 0;
+
+    /// @brief Sets the order in which CANObjects are processed every tick
+    /// @param policy Scheduling policy
+    virtual void SetSchedulingPolicy(can_scheduling_policy_t policy) = 0;
+
+    /// @brief Returns the order in which CANObjects are processed every tick
+    /// @return Scheduling policy
+    virtual can_scheduling_policy_t GetSchedulingPolicy() = 0;
+
+    /// @brief Sets the static priority of registered CANObject. It is used by CAN_SCHEDULING_STATIC_PRIORITY policy.
+    /// @param id ID of the CANObject
+    /// @param priority Priority of the CANObject: objects with higher values are processed first. Default priority is 0.
+    /// @return 'true' if the CANObject is registered, 'false' if it is not
+    virtual bool SetObjectPriority(can_object_id_t id, uint8_t priority) = 0;
+
+    /// @brief Limits the number of automatic frames sent by all CANObjects during one tick.
+    ///        Objects which don't fit into the limit are processed on the next ticks.
+    /// @param max_frames The number of frames. 0 means no limit.
+    virtual void SetMaxFramesPerTick(uint16_t max_frames) = 0;
+
+    /// @brief Returns statistics of automatic functions of registered CANObject
+    /// @param id ID of the CANObject
+    /// @param stats [OUT] Statistics of the CANObject
+    /// @return 'true' if the CANObject is registered, 'false' if it is not
+    virtual bool GetObjectStats(can_object_id_t id, can_object_stats_t &stats) = 0;
+
+    /// @brief Resets statistics of all registered CANObjects
+    virtual void ResetObjectsStats() = 0;
+
+    /// @brief Sets ID of the CANManager. It distinguishes CAN buses when several CANManagers are used.
+    /// @param manager_id ID of the CANManager
+    virtual void SetManagerId(uint8_t manager_id) = 0;
+
+    /// @brief Returns ID of the CANManager
+    /// @return ID of the CANManager
+    virtual uint8_t GetManagerId() = 0;
+
+    /// @brief Registers forwarder for incoming frames (e.g. a bridge to other CAN buses)
+    /// @param forwarder Pointer to the forwarder. nullptr disables forwarding.
+    virtual void RegisterForwarder(CANFrameForwarderInterface *forwarder) = 0;
+
+    /// @brief Registers capture tap for incoming and outgoing frames.
+    ///        The capture must not be shared with other CANManagers: its rings have a single producer.
+    /// @param capture Pointer to the capture. nullptr disables capturing.
+    virtual void RegisterCapture(CANCaptureInterface *capture) = 0;
+
+    /// @brief Registers profiler of handlers and processing phases. It is passed to all registered CANObjects.
+    /// @param profiler Pointer to the profiler. nullptr disables profiling.
+    virtual void RegisterProfiler(CANProfilerInterface *profiler) = 0;
+
+    /// @brief Registers liveness monitor of remote nodes. It observes all incoming frames and is processed every tick.
+    /// @param monitor Pointer to the monitor. nullptr disables monitoring.
+    virtual void RegisterLivenessMonitor(CANLivenessMonitorInterface *monitor) = 0;
+
+    /// @brief Attaches the TX budget of the whole node. It limits automatic frames and answers of all CANObjects.
+    /// @param tx_budget Pointer to the budget. nullptr removes the limits.
+    virtual void SetTxBudget(CANTxBudget *tx_budget) = 0;
+
+    /// @brief Returns the number of frames waiting for tokens of TX budgets
+    /// @return The number of deferred frames
+    virtual uint8_t GetNumOfDeferredFrames() = 0;
+
+    /// @brief Returns the number of incoming frames rejected before buffering (unsupported functions, wrong length, lock)
+    /// @return The number of rejected frames
+    virtual uint32_t GetNumOfRejectedFrames() = 0;
+
     /// @brief Registers low level function, that sends data via CAN bus
     /// @param can_send_func Pointer to the function
     virtual void RegisterSendFunction(can_send_function_t can_send_func) = 0;
 
+    /// @brief Registers low level function, that sends a batch of frames via CAN bus.
+    ///        If it is registered, it is used instead of the single frame sending function.
+    /// @param can_send_batch_func Pointer to the function. nullptr disables batched sending.
+    virtual void RegisterBatchSendFunction(can_send_batch_function_t can_send_batch_func) = 0;
+
+    /// @brief Returns low level function, that sends a batch of frames via CAN bus
+    /// @return Pointer to the function or nullptr if batched sending is disabled
+    virtual can_send_batch_function_t GetBatchSendFunction() = 0;
+
+    /// @brief Registers low level function of CAN FD controller, that sends data via CAN bus with format flags.
+    ///        If it is registered, it is used instead of the single frame sending function.
+    /// @param can_send_fd_func Pointer to the function. nullptr disables CAN FD sending.
+    virtual void RegisterFdSendFunction(can_send_fd_function_t can_send_fd_func) = 0;
+
+    /// @brief Sets format flags of outgoing frames for CAN FD controllers. Frames longer than 8 bytes are always sent in FD format.
+    /// @param flags Combination of can_frame_flags_t: CAN_FRAME_FLAG_FDF sends short frames in FD format too,
+    ///              CAN_FRAME_FLAG_BRS switches the bit rate of FD frames.
+    virtual void SetFdFrameFlags(uint8_t flags) = 0;
+
+    /// @brief Returns format flags of outgoing frames for CAN FD controllers
+    /// @return Combination of can_frame_flags_t
+    virtual uint8_t GetFdFrameFlags() = 0;
+
     /// @brief Performs CANObjects processing
     /// @param time Current time
     virtual void Process(uint32_t time) = 0;
 
+    /// @brief Performs CANObjects processing within the budget. The tick stops when the budget is exhausted
+    ///        and the next call resumes it from the same place (the next incoming frame or the next CANObject),
+    ///        so frames of every CANObject are processed in the same order as by Process(time).
+    ///        The new tick starts only after the current one is complete.
+    /// @param time Current time
+    /// @param budget Budget of the call: clock units if the clock is set with SetProcessClock(), the number of work items
+    ///               (incoming frames and CANObjects) if not. At least one work item is processed per call.
+    /// @return The number of work items of the current tick which are still pending, 0 if the tick is complete
+    virtual uint16_t Process(uint32_t time, uint32_t budget) = 0;
+
+    /// @brief Sets the clock for budgets of Process(time, budget)
+    /// @param clock_func Pointer to the function which returns free-running counter. nullptr makes budgets count work items.
+    virtual void SetProcessClock(can_clock_function_t clock_func) = 0;
+
+    /// @brief Returns the number of work items of the current tick which are still pending
+    /// @return The number of incoming frames and CANObjects left, 0 if the tick is complete
+    virtual uint16_t GetNumOfPendingWorkItems() = 0;
+
     /// @brief Processes incoming CAN frame (without any queues?)
     /// @param id CANObject ID from the CAN frame
     /// @param data Pointer to the data array
@@ -53,12 +210,26 @@ public:
     /// @return true if CANObject with ID is registered, false if not
     virtual bool IncomingCANFrame(can_object_id_t id, uint8_t *data, uint8_t length) = 0;
 
+    /// @brief Stores several incoming CAN frames in the buffer at once (e.g. drained hardware FIFO or DMA ring).
+    /// @param frames Array of incoming frames: object_id, raw_data, raw_data_length and time_ms (0 if unknown) are used.
+    /// @param count The number of frames in the array, up to 32.
+    /// @return Bit mask of accepted frames: bit N is set if frames[N] was stored in the buffer.
+    virtual uint32_t IncomingCANFrames(const can_frame_t *frames, uint8_t count) = 0;
+
     /// @brief Sends custom CAN frame
     /// @param can_object Sender CANObject. It is acceptable to use unregistered CANObject for generation of frames.
     /// @param function_id CAN function ID
     /// @param data Frame data to send in CAN frame
     /// @param data_length Frame data length
     virtual void SendCustomFrame(CANObjectInterface &can_object, can_function_id_t function_id, uint8_t *data = nullptr, uint8_t data_length = 0) = 0;
+
+    /// @brief Sends raw CAN frame without any CANObject processing (e.g. forwarded frames).
+    ///        The frame goes to the batch of outgoing frames if batched sending is used.
+    /// @param id CAN frame ID
+    /// @param data Frame data including function ID
+    /// @param length Frame data length including function ID
+    /// @return 'true' if the frame was passed to the sending function or to the batch
+    virtual bool SendRawFrame(can_object_id_t id, const uint8_t *data, uint8_t length) = 0;
 };
 
 /******************************************************************************************
@@ -67,10 +238,16 @@ public:
 /// @tparam _max_objects — The maximum number of CANObjects which can be handle by CANManager
 /// @tparam _can_frame_buffer_size — The size of buffer, measured in number of CAN frame structures
 /// @tparam tick_time — ms, the minimal period between CANManager::Process() informative calls
-template <uint8_t _max_objects = 16, uint8_t _can_frame_buffer_size = 16, uint8_t tick_time = 10>
+/// @tparam _tx_batch_size — The maximum number of outgoing CAN frames passed to the batched sending function at once
+/// @tparam _max_mirror_objects — The maximum number of mirror objects of remote CANObjects
+/// @tparam _max_registered_objects — The maximum number of CANObjects registered with RegisterObject() (RAM pointer array).
+///                                   0 for CANManagers which use CANObjectTable only.
+template <uint8_t _max_objects = 16, uint8_t _can_frame_buffer_size = 16, uint8_t tick_time = 10, uint8_t _tx_batch_size = 8,
+          uint8_t _max_mirror_objects = 4, uint8_t _max_registered_objects = _max_objects>
 class CANManager : public CANManagerInterface
 {
-    static_assert(_max_objects > 0); // 0 objects is not allowed
+    static_assert(_max_objects > 0);   // 0 objects is not allowed
+    static_assert(_tx_batch_size > 0); // 0 frames batch is not allowed
 public:
     /// @brief Default constructor is disabled
     CANManager() = delete;
@@ -80,19 +257,105 @@ public:
     CANManager(can_send_function_t can_send_func)
         : _send_func(can_send_func){};
 
+    /// @brief Creates CANManager and specifies external function, which sends batches of CAN frames
+    /// @param tag CAN_SEND_BATCH
+    /// @param can_send_batch_func Pointer to an external CAN frames batch sending handler
+    CANManager(can_send_batch_tag_t /*tag*/, can_send_batch_function_t can_send_batch_func)
+        : _send_batch_func(can_send_batch_func){};
+
+    /// @brief Creates CANManager and specifies external function of CAN FD controller, which sends CAN frames with format flags
+    /// @param tag CAN_SEND_FD
+    /// @param can_send_fd_func Pointer to an external CAN FD frames sending handler
+    CANManager(can_send_fd_tag_t /*tag*/, can_send_fd_function_t can_send_fd_func)
+        : _send_fd_func(can_send_fd_func){};
+
+    /// @brief Creates CANManager with the constant table of CANObjects. The objects can't be registered with RegisterObject().
+    /// @param object_table Table of CANObjects. It must exist during the whole life of CANManager (e.g. constexpr global).
+    /// @param can_send_func Pointer to an external CAN frames sending handler
+    template <uint8_t _table_size>
+    CANManager(const CANObjectTable<_table_size> &object_table, can_send_function_t can_send_func)
+        : _objects(object_table.GetObjects()), _objects_idx(_table_size),
+          _table_ids(object_table.GetIds()), _table_sorted_index(object_table.GetSortedIndex()),
+          _send_func(can_send_func)
+    {
+        static_assert(_table_size <= _max_objects); // runtime state of objects (priorities, statistics) is sized by _max_objects
+        _SortObjectsByPriority();
+    };
+
+    /// @brief Creates CANManager with the constant table of CANObjects. The objects can't be registered with RegisterObject().
+    /// @param object_table Table of CANObjects. It must exist during the whole life of CANManager (e.g. constexpr global).
+    /// @param tag CAN_SEND_BATCH
+    /// @param can_send_batch_func Pointer to an external CAN frames batch sending handler
+    template <uint8_t _table_size>
+    CANManager(const CANObjectTable<_table_size> &object_table, can_send_batch_tag_t /*tag*/, can_send_batch_function_t can_send_batch_func)
+        : _objects(object_table.GetObjects()), _objects_idx(_table_size),
+          _table_ids(object_table.GetIds()), _table_sorted_index(object_table.GetSortedIndex()),
+          _send_batch_func(can_send_batch_func)
+    {
+        static_assert(_table_size <= _max_objects); // runtime state of objects (priorities, statistics) is sized by _max_objects
+        _SortObjectsByPriority();
+    };
+
+    /// @brief Creates CANManager with the constant table of CANObjects. The objects can't be registered with RegisterObject().
+    /// @param object_table Table of CANObjects. It must exist during the whole life of CANManager (e.g. constexpr global).
+    /// @param tag CAN_SEND_FD
+    /// @param can_send_fd_func Pointer to an external CAN FD frames sending handler
+    template <uint8_t _table_size>
+    CANManager(const CANObjectTable<_table_size> &object_table, can_send_fd_tag_t /*tag*/, can_send_fd_function_t can_send_fd_func)
+        : _objects(object_table.GetObjects()), _objects_idx(_table_size),
+          _table_ids(object_table.GetIds()), _table_sorted_index(object_table.GetSortedIndex()),
+          _send_fd_func(can_send_fd_func)
+    {
+        static_assert(_table_size <= _max_objects); // runtime state of objects (priorities, statistics) is sized by _max_objects
+        _SortObjectsByPriority();
+    };
+
     /// @brief Registers specified CANObject
     /// @param can_object CANObject for registration
     /// @return 'true' if registration was successful, 'false' if not
     virtual bool RegisterObject(CANObjectInterface &can_object) override
     {
-        if (_max_objects <= _objects_idx)
+        // objects of the constant table can't be extended
+        if (_table_ids != nullptr || _max_registered_objects <= _objects_idx)
+            return false;
+
+        _objects_priority[_objects_idx] = 0;
+        _objects_stats[_objects_idx] = {};
+        _objects_storage[_objects_idx++] = &can_object;
+        _SortObjectsByPriority();
+        if (_profiler != nullptr)
+            can_object.SetProfiler(_profiler);
+
+        return true;
+    }
+
+    /// @brief Registers mirror object of the remote CANObject. Passing timer and event frames of the remote object will update it.
+    /// @param mirror_object Mirror object for registration
+    /// @return 'true' if registration was successful, 'false' if not
+    virtual bool RegisterMirrorObject(CANMirrorObjectInterface &mirror_object) override
+    {
+        if (_max_mirror_objects <= _mirrors_idx)
             return false;
 
-        _objects[_objects_idx++] = &can_object;
+        _mirrors[_mirrors_idx++] = &mirror_object;
 
         return true;
     }
 
+    /// @brief Searches for the mirror object among the registered ones
+    /// @param id ID of the remote CANObject
+    /// @return 'pointer to CANMirrorObjectInterface' if this mirror object is registered,
+    ///         'nullptr' if it was not found.
+    virtual CANMirrorObjectInterface *GetMirrorObject(can_object_id_t id) override
+    {
+        for (uint8_t i = 0; i < _mirrors_idx; i++)
+        {
+            if (_mirrors[i]->GetId() == id)
+                return _mirrors[i];
+        }
+        return nullptr;
+    }
+
     /// @brief Returns the number of CANObjects, which are registered in CANManager
     /// @return The number of CANObjects, which are registered in CANManager
     virtual uint8_t GetObjectsCount() override
@@ -114,19 +377,174 @@ public:
     ///         'nullptr' if CANObject was not found.
     virtual CANObjectInterface *GetCanObject(can_object_id_t id) override
     {
-        for (uint8_t i = 0; i < _objects_idx; i++)
-        {
-            if (_objects[i]->GetId() == id)
-                return _objects[i];
-        }
-        return nullptr;
+        int16_t obj_idx = _FindObjectIndex(id);
+        return (obj_idx < 0) ? nullptr : _objects[obj_idx];
     }
 
     /// @brief Returns The number of CAN frames stored in the buffer.
     /// @return The number of CAN frames stored in the buffer.
     virtual uint8_t GetNumOfFramesInBuffer() override
     {
-        return _frame_buffer_index;
+        return _RxCount(_rx_head);
+    }
+
+    /// @brief Returns the capacity of the incoming frames buffer
+    /// @return The maximum number of CAN frames stored in the buffer
+    virtual uint8_t GetBufferSize() override
+    {
+        return _can_frame_buffer_size;
+    }
+
+    /// @brief Spreads timer phases of all registered CANObjects with enabled timers evenly across their periods.
+    ///        It overrides the default ID-based phases, so it should be called after all objects are registered and configured.
+    virtual void SpreadTimerPhases() override
+    {
+        uint8_t timers_count = 0;
+        for (uint8_t i = 0; i < _objects_idx; i++)
+        {
+            if (_HasTimerEnabled(*_objects[i]))
+                timers_count++;
+        }
+
+        uint8_t timer_idx = 0;
+        for (uint8_t i = 0; i < _objects_idx; i++)
+        {
+            if (!_HasTimerEnabled(*_objects[i]))
+                continue;
+
+            _objects[i]->SetTimerPhase((uint32_t)_objects[i]->GetTimerPeriod() * timer_idx / timers_count);
+            timer_idx++;
+        }
+    }
+
+    /// @brief Sets the order in which CANObjects are processed every tick
+    /// @param policy Scheduling policy
+    virtual void SetSchedulingPolicy(can_scheduling_policy_t policy) override
+    {
+        _scheduling_policy = policy;
+    }
+
+    /// @brief Returns the order in which CANObjects are processed every tick
+    /// @return Scheduling policy
+    virtual can_scheduling_policy_t GetSchedulingPolicy() override
+    {
+        return _scheduling_policy;
+    }
+
+    /// @brief Sets the static priority of registered CANObject. It is used by CAN_SCHEDULING_STATIC_PRIORITY policy.
+    /// @param id ID of the CANObject
+    /// @param priority Priority of the CANObject: objects with higher values are processed first. Default priority is 0.
+    /// @return 'true' if the CANObject is registered, 'false' if it is not
+    virtual bool SetObjectPriority(can_object_id_t id, uint8_t priority) override
+    {
+        int16_t obj_idx = _FindObjectIndex(id);
+        if (obj_idx < 0)
+            return false;
+
+        _objects_priority[obj_idx] = priority;
+        _SortObjectsByPriority();
+        return true;
+    }
+
+    /// @brief Limits the number of automatic frames sent by all CANObjects during one tick.
+    ///        Objects which don't fit into the limit are processed on the next ticks.
+    /// @param max_frames The number of frames. 0 means no limit.
+    virtual void SetMaxFramesPerTick(uint16_t max_frames) override
+    {
+        _max_frames_per_tick = max_frames;
+    }
+
+    /// @brief Returns statistics of automatic functions of registered CANObject
+    /// @param id ID of the CANObject
+    /// @param stats [OUT] Statistics of the CANObject
+    /// @return 'true' if the CANObject is registered, 'false' if it is not
+    virtual bool GetObjectStats(can_object_id_t id, can_object_stats_t &stats) override
+    {
+        int16_t obj_idx = _FindObjectIndex(id);
+        if (obj_idx < 0)
+            return false;
+
+        stats = _objects_stats[obj_idx];
+        return true;
+    }
+
+    /// @brief Resets statistics of all registered CANObjects
+    virtual void ResetObjectsStats() override
+    {
+        for (uint8_t i = 0; i < _objects_idx; i++)
+        {
+            _objects_stats[i] = {};
+        }
+    }
+
+    /// @brief Sets ID of the CANManager. It distinguishes CAN buses when several CANManagers are used.
+    /// @param manager_id ID of the CANManager
+    virtual void SetManagerId(uint8_t manager_id) override
+    {
+        _manager_id = manager_id;
+    }
+
+    /// @brief Returns ID of the CANManager
+    /// @return ID of the CANManager
+    virtual uint8_t GetManagerId() override
+    {
+        return _manager_id;
+    }
+
+    /// @brief Registers forwarder for incoming frames (e.g. a bridge to other CAN buses)
+    /// @param forwarder Pointer to the forwarder. nullptr disables forwarding.
+    virtual void RegisterForwarder(CANFrameForwarderInterface *forwarder) override
+    {
+        _forwarder = forwarder;
+    }
+
+    /// @brief Registers capture tap for incoming and outgoing frames.
+    ///        The capture must not be shared with other CANManagers: its rings have a single producer.
+    /// @param capture Pointer to the capture. nullptr disables capturing.
+    virtual void RegisterCapture(CANCaptureInterface *capture) override
+    {
+        _capture = capture;
+    }
+
+    /// @brief Registers profiler of handlers and processing phases. It is passed to all registered CANObjects.
+    /// @param profiler Pointer to the profiler. nullptr disables profiling.
+    virtual void RegisterProfiler(CANProfilerInterface *profiler) override
+    {
+        _profiler = profiler;
+        for (uint8_t i = 0; i < _objects_idx; i++)
+            _objects[i]->SetProfiler(profiler);
+    }
+
+    /// @brief Registers liveness monitor of remote nodes. It observes all incoming frames (before the check of the ID,
+    ///        so frames of remote CANObjects are counted too) and is processed at the start of every tick.
+    ///        Error events of expired IDs are sent as TX_CLASS_ERROR frames.
+    /// @param monitor Pointer to the monitor. nullptr disables monitoring.
+    virtual void RegisterLivenessMonitor(CANLivenessMonitorInterface *monitor) override
+    {
+        _liveness = monitor;
+    }
+
+    /// @brief Attaches the TX budget of the whole node. It limits automatic frames and answers of all CANObjects.
+    ///        Frames over the budget are dropped or kept in the deferred queue (CAN_TX_DEFERRED_QUEUE_SIZE frames)
+    ///        according to the budget policy. Real-time, custom and raw frames are not limited.
+    /// @param tx_budget Pointer to the budget. nullptr removes the limits.
+    virtual void SetTxBudget(CANTxBudget *tx_budget) override
+    {
+        _tx_budget = tx_budget;
+    }
+
+    /// @brief Returns the number of frames waiting for tokens of TX budgets
+    /// @return The number of deferred frames
+    virtual uint8_t GetNumOfDeferredFrames() override
+    {
+        return _tx_deferred_count;
+    }
+
+    /// @brief Returns the number of incoming frames rejected before buffering (unsupported functions, wrong length, lock)
+    /// @return The number of rejected frames
+    virtual uint32_t GetNumOfRejectedFrames() override
+    {
+        return _rx_rejected_frames;
     }
 
     /// @brief Registers low level function, that sends data via CAN bus
@@ -139,118 +557,240 @@ public:
         _send_func = can_send_func;
     }
 
+    /// @brief Registers low level function, that sends a batch of frames via CAN bus.
+    ///        If it is registered, it is used instead of the single frame sending function.
+    /// @param can_send_batch_func Pointer to the function. nullptr disables batched sending.
+    virtual void RegisterBatchSendFunction(can_send_batch_function_t can_send_batch_func) override
+    {
+        _FlushTxBatch();
+        _send_batch_func = can_send_batch_func;
+    }
+
+    /// @brief Returns low level function, that sends a batch of frames via CAN bus
+    /// @return Pointer to the function or nullptr if batched sending is disabled
+    virtual can_send_batch_function_t GetBatchSendFunction() override
+    {
+        return _send_batch_func;
+    }
+
+    /// @brief Registers low level function of CAN FD controller, that sends data via CAN bus with format flags.
+    ///        If it is registered, it is used instead of the single frame sending function.
+    /// @param can_send_fd_func Pointer to the function. nullptr disables CAN FD sending.
+    virtual void RegisterFdSendFunction(can_send_fd_function_t can_send_fd_func) override
+    {
+        _send_fd_func = can_send_fd_func;
+    }
+
+    /// @brief Sets format flags of outgoing frames for CAN FD controllers. Frames longer than 8 bytes are always sent in FD format.
+    ///        The flags are passed to the CAN FD sending function and are stored in the frames of batches.
+    /// @param flags Combination of can_frame_flags_t: CAN_FRAME_FLAG_FDF sends short frames in FD format too,
+    ///              CAN_FRAME_FLAG_BRS switches the bit rate of FD frames.
+    virtual void SetFdFrameFlags(uint8_t flags) override
+    {
+        _fd_frame_flags = flags & (CAN_FRAME_FLAG_FDF | CAN_FRAME_FLAG_BRS);
+    }
+
+    /// @brief Returns format flags of outgoing frames for CAN FD controllers
+    /// @return Combination of can_frame_flags_t
+    virtual uint8_t GetFdFrameFlags() override
+    {
+        return _fd_frame_flags;
+    }
+
     /// @brief Performs CANObjects processing
     /// @param time Current time
     virtual void Process(uint32_t time) override
     {
-        if (time - _last_tick < tick_time)
-            return;
+        Process(time, CAN_PROCESS_BUDGET_UNLIMITED);
+    }
 
-        _last_tick = time;
+    /// @brief Performs CANObjects processing within the budget. The tick stops when the budget is exhausted
+    ///        and the next call resumes it from the same place (the next incoming frame or the next CANObject),
+    ///        so frames of every CANObject are processed in the same order as by Process(time).
+    ///        The new tick starts only after the current one is complete.
+    /// @param time Current time
+    /// @param budget Budget of the call: clock units if the clock is set with SetProcessClock(), the number of work items
+    ///               (incoming frames and CANObjects) if not. At least one work item is processed per call.
+    /// @return The number of work items of the current tick which are still pending, 0 if the tick is complete
+    virtual uint16_t Process(uint32_t time, uint32_t budget) override
+    {
+        if (_capture != nullptr)
+            _capture->SetTime(time);
 
-        // Process all incoming CAN frames in the buffer
-        if (_frame_buffer_index > 0)
+        if (!_tick_pending)
         {
-            CANObjectInterface *can_object = nullptr;
-            for (uint8_t i = 0; i < _frame_buffer_index; i++)
-            {
-                // set time for canframe (assume CAN frame comes now)
-                _can_frame_buffer[i].time_ms = time;
+            if (time - _last_tick < tick_time)
+                return 0;
 
-                // transfer broadcast frames to all registered CAN-Objects
-                if (_can_frame_buffer[i].object_id == CAN_SYSTEM_ID_BROADCAST)
-                {
-                    if (!_IsBroadcastFunctionAllowed(_can_frame_buffer[i].function_id))
-                    {
-                        _can_frame_buffer[i].initialized = false;
-                        continue;
-                    }
-
-                    can_frame_t broadcast_can_frame;
-                    for (uint8_t obj_idx = 0; obj_idx < _objects_idx; ++obj_idx)
-                    {
-                        clear_can_frame_struct(broadcast_can_frame);
-                        copy_can_frame_struct(broadcast_can_frame, _can_frame_buffer[i]);
-                        if (CAN_RESULT_IGNORE == _objects[obj_idx]->InputCanFrame(broadcast_can_frame, _tx_error))
-                            continue;
-
-                        _ValidateAndFillErrorCanFrame(broadcast_can_frame, _tx_error);
-                        broadcast_can_frame.object_id = _objects[obj_idx]->GetId();
-                        _SendCanData(broadcast_can_frame);
-                    }
-                }
-                // process all frames for specific CAN-Objects
-                else
-                {
-                    can_object = GetCanObject(_can_frame_buffer[i].object_id);
-                    // don't check for nullptr here because existing of the object was checked in IncomingCANFrame()
-                    // if (can_object == nullptr)
-                    // {
-                    //     _can_frame_buffer[i].initialized = false;
-                    //     continue;
-                    // }
-                    if (CAN_RESULT_IGNORE == can_object->InputCanFrame(_can_frame_buffer[i], _tx_error))
-                    {
-                        _can_frame_buffer[i].initialized = false;
-                        continue;
-                    }
-
-                    _ValidateAndFillErrorCanFrame(_can_frame_buffer[i], _tx_error);
-                    _SendCanData(_can_frame_buffer[i]);
-                }
-                _can_frame_buffer[i].initialized = false;
+            _last_tick = time;
+
+#ifndef NDEBUG
+            // objects of the constant table are surely constructed at the first tick
+            if (_table_ids != nullptr && !_table_ids_checked)
+            {
+                assert(_AreTableIdsConsistent()); // frames are routed by IDs of the table, objects answer with their own IDs
+                _table_ids_checked = true;
             }
-            // buffer is clear, we can write frame in the first item of buffer
-            _frame_buffer_index = 0;
+#endif
+
+            _BuildSchedule(time);
+
+            // remote nodes which went quiet
+            if (_liveness != nullptr)
+                _ProcessLiveness(time);
+
+            // frames deferred by TX budgets go first
+            _SendDeferredFrames(time);
+
+            // only frames which were stored before the start of the tick are processed in it
+            _tick_rx_head = _rx_head;
+            _tick_objects_count = _objects_idx;
+            _tick_sched_idx = 0;
+            _tick_frames_sent = 0;
+            _tick_pending = true;
         }
 
-        clear_can_error_struct(_tx_error);
-        clear_can_frame_struct(_tx_can_frame);
+        uint32_t budget_start = (_process_clock != nullptr) ? _process_clock() : 0;
+        uint32_t work_items = 0;
+
+        // Process incoming CAN frames of the tick
+        uint32_t start_cycles = (_profiler != nullptr) ? _profiler->GetCycles() : 0;
+        while (_rx_tail != _tick_rx_head && !_IsProcessBudgetExhausted(budget, budget_start, work_items))
+        {
+            // error answers to the frames rejected before this one keep the arrival order
+            _SendRejectedFramesErrors(time);
+
+            can_frame_t &can_frame = _can_frame_buffer[_RxSlot(_rx_tail)];
+            bool is_lock_frame = can_frame.function_id == CAN_FUNC_LOCK_IN;
+            _ProcessIncomingCanFrame(can_frame, time);
+            can_frame.initialized = false;
+            if (is_lock_frame)
+                _rx_lock_frames_processed++;
+            _rx_tail = _RxNextIndex(_rx_tail);
+            work_items++;
+        }
+        _SendRejectedFramesErrors(time);
+        if (_profiler != nullptr && work_items > 0)
+            _profiler->RecordPhase(CAN_PROFILE_PHASE_RX, start_cycles);
 
         // Process automatic functions of CANObjects
-        for (uint8_t i = 0; i < _objects_idx; ++i)
+        uint32_t rx_work_items = work_items;
+        if (_profiler != nullptr)
+            start_cycles = _profiler->GetCycles();
+        while (_rx_tail == _tick_rx_head && _tick_sched_idx < _tick_objects_count &&
+               !_IsProcessBudgetExhausted(budget, budget_start, work_items))
         {
-            if (CAN_RESULT_IGNORE == _objects[i]->Process(time, _tx_can_frame, _tx_error))
-                continue;
+            _ProcessObject(_schedule[_tick_sched_idx++], time);
+            work_items++;
+        }
 
-            _ValidateAndFillErrorCanFrame(_tx_can_frame, _tx_error);
+        _FlushTxBatch();
+        if (_profiler != nullptr && work_items > rx_work_items)
+            _profiler->RecordPhase(CAN_PROFILE_PHASE_TX, start_cycles);
 
-            // restoring ID (if it was overwritten by the handler)
-            _tx_can_frame.object_id = _objects[i]->GetId();
+        uint16_t pending_items = GetNumOfPendingWorkItems();
+        _tick_pending = pending_items > 0;
+        return pending_items;
+    }
 
-            _SendCanData(_tx_can_frame);
-        }
+    /// @brief Sets the clock for budgets of Process(time, budget)
+    /// @param clock_func Pointer to the function which returns free-running counter. nullptr makes budgets count work items.
+    virtual void SetProcessClock(can_clock_function_t clock_func) override
+    {
+        _process_clock = clock_func;
+    }
+
+    /// @brief Returns the number of work items of the current tick which are still pending
+    /// @return The number of incoming frames and CANObjects left, 0 if the tick is complete
+    virtual uint16_t GetNumOfPendingWorkItems() override
+    {
+        if (!_tick_pending)
+            return 0;
+
+        return _RxCount(_tick_rx_head) + (_tick_objects_count - _tick_sched_idx);
     }
 
     /// @brief Stores incoming CAN framein the buffer.
     ///        Frame processing will start when the Process() method is called the next time.
     /// @param id CANObject ID from the CAN frame
     /// @param data Pointer to the data array
-    /// @param length Data length
-    /// @return true if data length exceeds 0 and a CANObject with the ID is registered, false if not
+    /// @param length Data length (CAN FD frames: can_dlc_to_length() of the DLC, padding included)
+    ///        Frames which the CANObject would reject (unsupported functions, wrong length, lock) are not stored:
+    ///        their error answers are sent by Process() after the answers to the frames stored before them.
+    /// @return true if data length is correct, a CANObject with the ID is registered and the buffer has free space; false if not
     virtual bool IncomingCANFrame(can_object_id_t id, uint8_t *data, uint8_t length) override
     {
-        if (data == nullptr || length == 0)
-            return false;
+        if (_capture != nullptr && data != nullptr)
+            _capture->Capture(CAN_CAPTURE_DIRECTION_RX, _manager_id, id, data, length);
 
-        if (!HasCanObject(id) && id != CAN_SYSTEM_ID_BROADCAST)
-            return false;
+        if (_liveness != nullptr)
+            _liveness->Observe(id);
 
-        if (id == CAN_SYSTEM_ID_BROADCAST && !_IsBroadcastFunctionAllowed((can_function_id_t)data[0]))
+        uint16_t rx_head = _rx_head;
+        if (!_IsAcceptableIncomingFrame(id, data, length, rx_head, nullptr))
             return false;
 
-        _can_frame_buffer[_frame_buffer_index].object_id = id;
-        memcpy(_can_frame_buffer[_frame_buffer_index].raw_data, data, length);
-        _can_frame_buffer[_frame_buffer_index].raw_data_length = length;
-        _can_frame_buffer[_frame_buffer_index].initialized = true;
+        if (_RxCount(rx_head) >= _can_frame_buffer_size)
+            return false;
 
-        _frame_buffer_index++;
-        if (_frame_buffer_index >= _can_frame_buffer_size)
-            _frame_buffer_index = 0;
+        _StoreIncomingFrame(_can_frame_buffer[_RxSlot(rx_head)], id, data, length, 0);
+        _rx_head = _RxNextIndex(rx_head);
 
         return true;
     }
 
+    /// @brief Stores several incoming CAN frames in the buffer at once (e.g. drained hardware FIFO or DMA ring).
+    ///        Frame processing will start when the Process() method is called the next time.
+    /// @param frames Array of incoming frames: object_id, raw_data, raw_data_length and time_ms (0 if unknown) are used.
+    /// @param count The number of frames in the array, up to 32.
+    /// @return Bit mask of accepted frames: bit N is set if frames[N] was stored in the buffer.
+    virtual uint32_t IncomingCANFrames(const can_frame_t *frames, uint8_t count) override
+    {
+        if (frames == nullptr)
+            return 0;
+
+        if (count > 32)
+            count = 32;
+
+        uint32_t accepted_mask = 0;
+        uint16_t rx_head = _rx_head;
+        uint8_t free_slots = _can_frame_buffer_size - _RxCount(rx_head);
+        rx_lookup_cache_t lookup_cache;
+        for (uint8_t i = 0; i < count; i++)
+        {
+            const can_frame_t &frame = frames[i];
+            if (_capture != nullptr)
+                _capture->Capture(CAN_CAPTURE_DIRECTION_RX, _manager_id, frame.object_id, frame.raw_data, frame.raw_data_length, frame.time_ms);
+
+            if (_liveness != nullptr)
+            {
+                if (frame.time_ms != 0)
+                    _liveness->Observe(frame.object_id, frame.time_ms);
+                else
+                    _liveness->Observe(frame.object_id);
+            }
+
+            if (free_slots == 0)
+            {
+                if (_capture == nullptr)
+                    break;
+                continue;
+            }
+
+            if (!_IsAcceptableIncomingFrame(frame.object_id, frame.raw_data, frame.raw_data_length, rx_head, &lookup_cache))
+                continue;
+
+            _StoreIncomingFrame(_can_frame_buffer[_RxSlot(rx_head)], frame.object_id, frame.raw_data, frame.raw_data_length, frame.time_ms);
+            rx_head = _RxNextIndex(rx_head);
+            free_slots--;
+            accepted_mask |= (uint32_t)1 << i;
+        }
+        // publish all stored frames at once
+        _rx_head = rx_head;
+
+        return accepted_mask;
+    }
+
     /// @brief Sends custom CAN frame
     /// @param can_object Sender CANObject. It is acceptable to use unregistered CANObject for generation of frames.
     /// @param function_id CAN function ID
@@ -267,41 +807,612 @@ public:
         // restoring ID (if it was overwritten by the handler)
         _tx_can_frame.object_id = can_object.GetId();
         _SendCanData(_tx_can_frame);
+        _FlushTxBatch();
     };
 
+    /// @brief Sends raw CAN frame without any CANObject processing (e.g. forwarded frames).
+    ///        The frame goes to the batch of outgoing frames if batched sending is used.
+    /// @param id CAN frame ID
+    /// @param data Frame data including function ID
+    /// @param length Frame data length including function ID
+    /// @return 'true' if the frame was passed to the sending function or to the batch
+    virtual bool SendRawFrame(can_object_id_t id, const uint8_t *data, uint8_t length) override
+    {
+        if (data == nullptr || length == 0 || length > CAN_FRAME_MAX_PAYLOAD + 1)
+            return false;
+
+        return _SendRawData(id, data, length);
+    }
+
 private:
     // data structures for outgoing CAN frames & errors
     can_frame_t _tx_can_frame = {};
     can_error_t _tx_error = {};
 
-    // buffer for incoming can frames
-    // new frames will overwrite old ones regardless of can manager's processing speed
+    // ring buffer for incoming can frames
+    // IncomingCANFrame() writes at _rx_head only, Process() reads at _rx_tail only, so they can run in different contexts (ISR & main loop).
+    // Indexes run over [0, 2 * _can_frame_buffer_size) to distinguish the full buffer from the empty one.
+    // New frames are rejected while the buffer is full.
     can_frame_t _can_frame_buffer[_can_frame_buffer_size] = {};
-    uint8_t _frame_buffer_index = 0;
-    static_assert(_can_frame_buffer_size <= UINT8_MAX); // static _frame_buffer_index overflow check
+    volatile uint16_t _rx_head = 0;
+    volatile uint16_t _rx_tail = 0;
+    static_assert(_can_frame_buffer_size > 0);          // 0 frames buffer is not allowed
+    static_assert(_can_frame_buffer_size <= UINT8_MAX); // GetNumOfFramesInBuffer() overflow check
+
+    // incoming frames rejected before buffering; their error answers wait for Process() (single producer, single consumer)
+    struct rx_rejected_frame_t
+    {
+        can_object_id_t object_id;
+        can_error_t error;
+        uint16_t rx_index; // _rx_head at rejection: the answer waits until _rx_tail reaches it
+    };
+    rx_rejected_frame_t _rx_errors[CAN_RX_ERROR_QUEUE_SIZE] = {};
+    volatile uint8_t _rx_errors_head = 0;
+    volatile uint8_t _rx_errors_tail = 0;
+    volatile uint32_t _rx_rejected_frames = 0;
+    static_assert(CAN_RX_ERROR_QUEUE_SIZE > 0 && (CAN_RX_ERROR_QUEUE_SIZE & (CAN_RX_ERROR_QUEUE_SIZE - 1)) == 0);
+    static_assert(CAN_RX_ERROR_QUEUE_SIZE <= 128); // free-running uint8_t indexes
+
+    // LOCK frames stored in the buffer and processed: the lock level isn't checked before buffering while they differ
+    volatile uint16_t _rx_lock_frames_stored = 0;
+    volatile uint16_t _rx_lock_frames_processed = 0;
+
+    // the last CANObject found by IncomingCANFrames()
+    struct rx_lookup_cache_t
+    {
+        can_object_id_t id = CAN_SYSTEM_ID_BROADCAST;
+        CANObjectInterface *object = nullptr;
+    };
 
-    // registered CANObjects of the CANManager
-    CANObjectInterface *_objects[_max_objects] = {nullptr};
+    // registered CANObjects of the CANManager: RAM array filled by RegisterObject() or the constant table
+    CANObjectInterface *_objects_storage[_max_registered_objects > 0 ? _max_registered_objects : 1] = {nullptr};
+    CANObjectInterface *const *_objects = _objects_storage;
     uint8_t _objects_idx = 0;
     static_assert(_max_objects <= UINT8_MAX); // static _objects_idx overflow check
+    static_assert(_max_registered_objects <= _max_objects);
+
+    // dispatch index of the constant table (nullptr if objects are registered at runtime)
+    const can_object_id_t *_table_ids = nullptr;
+    const uint8_t *_table_sorted_index = nullptr;
+#ifndef NDEBUG
+    bool _table_ids_checked = false;
+#endif
+
+    // scheduling of CANObjects
+    can_scheduling_policy_t _scheduling_policy = CAN_SCHEDULING_REGISTRATION_ORDER;
+    uint8_t _objects_priority[_max_objects] = {0};
+    uint8_t _objects_by_priority[_max_objects] = {0}; // indexes of objects sorted by priority
+    uint8_t _schedule[_max_objects] = {0};            // indexes of objects in the order of processing in the current tick
+    uint8_t _round_robin_offset = 0;
+    uint16_t _max_frames_per_tick = 0;
+    can_object_stats_t _objects_stats[_max_objects] = {};
+
+    uint8_t _manager_id = 0;
+    CANFrameForwarderInterface *_forwarder = nullptr;
+    CANCaptureInterface *_capture = nullptr;
+    CANProfilerInterface *_profiler = nullptr;
+    CANLivenessMonitorInterface *_liveness = nullptr;
+
+    // outgoing frames waiting for tokens of TX budgets
+    struct tx_deferred_frame_t
+    {
+        can_frame_t frame;
+        can_tx_class_t tx_class;
+        CANTxBudget *object_budget; // the budget of the object (answers only)
+    };
+    CANTxBudget *_tx_budget = nullptr;
+    tx_deferred_frame_t _tx_deferred[CAN_TX_DEFERRED_QUEUE_SIZE > 0 ? CAN_TX_DEFERRED_QUEUE_SIZE : 1] = {};
+    uint8_t _tx_deferred_count = 0;
+    static_assert(CAN_TX_DEFERRED_QUEUE_SIZE <= UINT8_MAX);
+
+    // mirror objects of remote CANObjects
+    CANMirrorObjectInterface *_mirrors[_max_mirror_objects > 0 ? _max_mirror_objects : 1] = {nullptr};
+    uint8_t _mirrors_idx = 0;
 
     can_send_function_t _send_func = nullptr;
+    can_send_batch_function_t _send_batch_func = nullptr;
+    can_send_fd_function_t _send_fd_func = nullptr;
+    uint8_t _fd_frame_flags = CAN_FRAME_FLAG_NONE;
+
+    // outgoing CAN frames collected for the batched sending function
+    can_frame_t _tx_batch[_tx_batch_size] = {};
+    uint8_t _tx_batch_count = 0;
 
     uint32_t _last_tick = 0;
 
+    // state of the tick interrupted by the budget of Process(time, budget)
+    can_clock_function_t _process_clock = nullptr;
+    bool _tick_pending = false;
+    uint16_t _tick_rx_head = 0;       // the end of incoming frames of the tick
+    uint8_t _tick_objects_count = 0;  // the number of CANObjects in the schedule of the tick
+    uint8_t _tick_sched_idx = 0;      // the next CANObject in the schedule
+    uint16_t _tick_frames_sent = 0;   // frames sent by CANObjects in the tick
+
+    /// @brief Checks whether the budget of Process(time, budget) is exhausted
+    /// @param budget Budget of the call
+    /// @param budget_start Clock value at the start of the call
+    /// @param work_items The number of work items done in the call
+    /// @return 'true' if the processing should stop. The first work item of the call is always allowed.
+    bool _IsProcessBudgetExhausted(uint32_t budget, uint32_t budget_start, uint32_t work_items)
+    {
+        if (work_items == 0 || budget == CAN_PROCESS_BUDGET_UNLIMITED)
+            return false;
+
+        if (_process_clock != nullptr)
+            return _process_clock() - budget_start >= budget;
+
+        return work_items >= budget;
+    }
+
+    /// @brief Processes automatic functions of the CANObject and sends its frames
+    /// @param i Index of the CANObject
+    /// @param time Current time
+    void _ProcessObject(uint8_t i, uint32_t time)
+    {
+        uint32_t deadline = time;
+        bool has_deadline = _objects[i]->GetNextDeadline(time, deadline);
+
+        if (_max_frames_per_tick > 0 && _tick_frames_sent >= _max_frames_per_tick)
+        {
+            if (has_deadline && (int32_t)(time - deadline) >= 0)
+                _objects_stats[i].skipped_ticks++;
+            return;
+        }
+
+        // object returns its due frames one by one in the order of priority; CAN_RESULT_IGNORE means there are no more frames.
+        // The extra call after the limit allows the object to account postponed functions.
+        for (uint16_t frame_idx = 0; frame_idx <= _objects[i]->GetMaxFramesPerTick(); ++frame_idx)
+        {
+            if (_max_frames_per_tick > 0 && _tick_frames_sent >= _max_frames_per_tick)
+                break;
+
+            clear_can_error_struct(_tx_error);
+            clear_can_frame_struct(_tx_can_frame);
+
+            if (CAN_RESULT_IGNORE == _objects[i]->Process(time, _tx_can_frame, _tx_error))
+                break;
+
+            _ValidateAndFillErrorCanFrame(_tx_can_frame, _tx_error);
+
+            // restoring ID (if it was overwritten by the handler)
+            _tx_can_frame.object_id = _objects[i]->GetId();
+
+            // the budget of the object was checked by the object itself
+            if (_SendBudgetedCanData(_tx_can_frame, _GetFrameTxClass(_tx_can_frame.function_id), nullptr, time))
+            {
+                _UpdateObjectStats(i, time, has_deadline ? deadline : time);
+                _tick_frames_sent++;
+            }
+
+            has_deadline = _objects[i]->GetNextDeadline(time, deadline);
+        }
+    }
+
+    /// @brief Returns the number of frames in the incoming buffer
+    /// @param rx_head Current head index of the buffer
+    /// @return The number of frames
+    uint8_t _RxCount(uint16_t rx_head)
+    {
+        uint16_t rx_tail = _rx_tail;
+        return (rx_head >= rx_tail) ? rx_head - rx_tail : rx_head + 2 * _can_frame_buffer_size - rx_tail;
+    }
+
+    /// @brief Converts ring index to the slot of the incoming buffer
+    /// @param index Ring index in range [0, 2 * _can_frame_buffer_size)
+    /// @return Slot index in range [0, _can_frame_buffer_size)
+    static uint8_t _RxSlot(uint16_t index)
+    {
+        return (index >= _can_frame_buffer_size) ? index - _can_frame_buffer_size : index;
+    }
+
+    /// @brief Returns the next ring index of the incoming buffer
+    /// @param index Ring index in range [0, 2 * _can_frame_buffer_size)
+    /// @return The next ring index
+    static uint16_t _RxNextIndex(uint16_t index)
+    {
+        return (index + 1 >= 2 * _can_frame_buffer_size) ? 0 : index + 1;
+    }
+
+#ifndef NDEBUG
+    /// @brief Checks that IDs of the constant table are the same as IDs of its objects
+    /// @return 'true' if every object has the ID of its entry
+    bool _AreTableIdsConsistent()
+    {
+        for (uint8_t i = 0; i < _objects_idx; i++)
+        {
+            if (_objects[i]->GetId() != _table_ids[i])
+                return false;
+        }
+        return true;
+    }
+#endif
+
+    /// @brief Searches for the CANObject index: binary search in the dispatch index of the constant table
+    ///        or linear search among the registered objects
+    /// @param id ID of the CANObject
+    /// @return Index of the CANObject or -1 if it wasn't found
+    int16_t _FindObjectIndex(can_object_id_t id)
+    {
+        if (_table_ids != nullptr)
+            return can_object_table_find_index(_table_ids, _table_sorted_index, _objects_idx, id);
+
+        for (uint8_t i = 0; i < _objects_idx; i++)
+        {
+            if (_objects[i]->GetId() == id)
+                return i;
+        }
+        return -1;
+    }
+
+    /// @brief Checks whether incoming frame should be stored in the buffer
+    /// @param id CANObject ID from the CAN frame
+    /// @param data Pointer to the data array
+    /// @param length Data length
+    /// @param rx_index Buffer index the frame would be stored at
+    /// @param lookup_cache [IN, OUT] Cache of the last registered CANObject found (bulk processing), nullptr if not used
+    /// @return 'true' if the frame is acceptable
+    bool _IsAcceptableIncomingFrame(can_object_id_t id, const uint8_t *data, uint8_t length, uint16_t rx_index, rx_lookup_cache_t *lookup_cache)
+    {
+        if (data == nullptr || length == 0 || length > CAN_FRAME_MAX_PAYLOAD + 1)
+            return false;
+
+        if (id == CAN_SYSTEM_ID_BROADCAST)
+            return _IsBroadcastFunctionAllowed((can_function_id_t)data[0]) ||
+                   (_forwarder != nullptr && _forwarder->IsForwarded(_manager_id, id, (can_function_id_t)data[0]));
+
+        CANObjectInterface *can_object = nullptr;
+        if (lookup_cache != nullptr && lookup_cache->object != nullptr && lookup_cache->id == id)
+            can_object = lookup_cache->object;
+        else
+            can_object = GetCanObject(id);
+
+        if (can_object == nullptr)
+        {
+            if (_forwarder != nullptr && _forwarder->IsForwarded(_manager_id, id, (can_function_id_t)data[0]))
+                return true;
+
+            // passing frames of remote objects are stored for their mirrors
+            CANMirrorObjectInterface *mirror_object = GetMirrorObject(id);
+            return mirror_object != nullptr && mirror_object->IsMirroredFunction((can_function_id_t)data[0]);
+        }
+
+        if (lookup_cache != nullptr)
+        {
+            lookup_cache->id = id;
+            lookup_cache->object = can_object;
+        }
+
+        // the lock level is checked only if no LOCK frame waits in the buffer
+        can_error_t error;
+        bool check_lock = _rx_lock_frames_stored == _rx_lock_frames_processed;
+        can_result_t result = can_object->ValidateIncomingFrame(data, length, check_lock, error);
+        if (result == CAN_RESULT_CAN_FRAME)
+            return true;
+
+        // forwarded frames are stored anyway, the CANObject answers them in Process()
+        if (_forwarder != nullptr && _forwarder->IsForwarded(_manager_id, id, (can_function_id_t)data[0]))
+            return true;
+
+        _rx_rejected_frames++;
+        if (result == CAN_RESULT_ERROR)
+            _PushRejectedFrameError(id, error, rx_index);
+
+        return false;
+    }
+
+    /// @brief Stores the error answer to the rejected incoming frame.
+    ///        It is sent by Process() once the frames stored before it are processed. The answer is lost if the queue is full.
+    /// @param id CANObject ID from the CAN frame
+    /// @param error Error answer
+    /// @param rx_index Buffer index the frame would be stored at
+    void _PushRejectedFrameError(can_object_id_t id, const can_error_t &error, uint16_t rx_index)
+    {
+        uint8_t head = _rx_errors_head;
+        if ((uint8_t)(head - _rx_errors_tail) >= CAN_RX_ERROR_QUEUE_SIZE)
+            return;
+
+        rx_rejected_frame_t &rejected = _rx_errors[head & (CAN_RX_ERROR_QUEUE_SIZE - 1)];
+        rejected.object_id = id;
+        rejected.error = error;
+        rejected.rx_index = rx_index;
+
+        // publish the answer
+        _rx_errors_head = head + 1;
+    }
+
+    /// @brief Handles expired IDs of the liveness monitor and sends their error events
+    /// @param time Current time
+    void _ProcessLiveness(uint32_t time)
+    {
+        can_object_id_t reporter_id;
+        can_object_id_t expired_id;
+        while (_liveness->ProcessNext(time, expired_id))
+        {
+            if (!_liveness->GetErrorEvent(reporter_id))
+                continue;
+
+            can_frame_t error_frame;
+            clear_can_frame_struct(error_frame);
+            error_frame.object_id = reporter_id;
+            error_frame.initialized = true;
+            error_frame.function_id = CAN_FUNC_EVENT_ERROR;
+            error_frame.data[0] = ERROR_SECTION_CAN_MANAGER;
+            error_frame.data[1] = ERROR_CODE_MANAGER_REMOTE_NODE_TIMEOUT;
+            can_wire_encode(&error_frame.data[2], &expired_id, 1);
+            error_frame.raw_data_length = sizeof(error_frame.function_id) + 2 + sizeof(expired_id);
+
+            CANObjectInterface *can_object = GetCanObject(reporter_id);
+            _SendBudgetedCanData(error_frame, CAN_TX_CLASS_ERROR, can_object != nullptr ? can_object->GetTxBudget() : nullptr, time);
+        }
+    }
+
+    /// @brief Sends the error answers to the frames rejected by IncomingCANFrame()
+    ///        whose preceding stored frames are already processed
+    /// @param time Current time
+    void _SendRejectedFramesErrors(uint32_t time)
+    {
+        uint8_t head = _rx_errors_head;
+        while (_rx_errors_tail != head)
+        {
+            rx_rejected_frame_t &rejected = _rx_errors[_rx_errors_tail & (CAN_RX_ERROR_QUEUE_SIZE - 1)];
+            if (rejected.rx_index != _rx_tail)
+                break;
+
+            can_frame_t error_frame;
+            clear_can_frame_struct(error_frame);
+            error_frame.object_id = rejected.object_id;
+            _FillErrorCanFrame(error_frame, rejected.error);
+
+            CANObjectInterface *can_object = GetCanObject(rejected.object_id);
+            _SendBudgetedCanData(error_frame, CAN_TX_CLASS_RESPONSE, can_object != nullptr ? can_object->GetTxBudget() : nullptr, time);
+            _rx_errors_tail = _rx_errors_tail + 1;
+        }
+    }
+
+    /// @brief Fills the slot of the incoming buffer
+    /// @param can_frame Slot of the incoming buffer
+    /// @param id CANObject ID from the CAN frame
+    /// @param data Pointer to the data array
+    /// @param length Data length
+    /// @param time_ms Time of frame receiving; 0 if unknown (the time of Process() call will be used)
+    void _StoreIncomingFrame(can_frame_t &can_frame, can_object_id_t id, const uint8_t *data, uint8_t length, uint32_t time_ms)
+    {
+        if (data[0] == CAN_FUNC_LOCK_IN)
+            _rx_lock_frames_stored++;
+
+        can_frame.object_id = id;
+        memcpy(can_frame.raw_data, data, length);
+        can_frame.raw_data_length = length;
+        can_frame.time_ms = time_ms;
+        can_frame.initialized = true;
+    }
+
+    /// @brief Passes incoming CAN frame from the buffer to the CANObject(s) and sends the answers
+    /// @param can_frame Incoming CAN frame
+    /// @param time Current time
+    void _ProcessIncomingCanFrame(can_frame_t &can_frame, uint32_t time)
+    {
+        // set time for canframe (assume CAN frame comes now) if receiving time is unknown
+        if (can_frame.time_ms == 0)
+            can_frame.time_ms = time;
+
+        // forwarding goes first: local processing overwrites the frame with the answer
+        if (_forwarder != nullptr && _forwarder->IsForwarded(_manager_id, can_frame.object_id, can_frame.function_id))
+            _forwarder->ForwardFrame(_manager_id, can_frame);
+
+        // transfer broadcast frames to all registered CAN-Objects
+        if (can_frame.object_id == CAN_SYSTEM_ID_BROADCAST)
+        {
+            if (!_IsBroadcastFunctionAllowed(can_frame.function_id))
+                return;
+
+            can_frame_t broadcast_can_frame;
+            for (uint8_t sched_idx = 0; sched_idx < _objects_idx; ++sched_idx)
+            {
+                uint8_t obj_idx = _schedule[sched_idx];
+                clear_can_frame_struct(broadcast_can_frame);
+                copy_can_frame_struct(broadcast_can_frame, can_frame);
+                if (CAN_RESULT_IGNORE == _objects[obj_idx]->InputCanFrame(broadcast_can_frame, _tx_error))
+                    continue;
+
+                _ValidateAndFillErrorCanFrame(broadcast_can_frame, _tx_error);
+                broadcast_can_frame.object_id = _objects[obj_idx]->GetId();
+                _SendBudgetedCanData(broadcast_can_frame, CAN_TX_CLASS_RESPONSE, _objects[obj_idx]->GetTxBudget(), time);
+            }
+            return;
+        }
+
+        // process all frames for specific CAN-Objects
+        CANObjectInterface *can_object = GetCanObject(can_frame.object_id);
+        if (can_object == nullptr)
+        {
+            // existing of the object or its mirror was checked in IncomingCANFrame(); mirrors never answer
+            CANMirrorObjectInterface *mirror_object = GetMirrorObject(can_frame.object_id);
+            if (mirror_object != nullptr)
+                mirror_object->UpdateFromCanFrame(can_frame);
+            return;
+        }
+
+        if (CAN_RESULT_IGNORE == can_object->InputCanFrame(can_frame, _tx_error))
+            return;
+
+        _ValidateAndFillErrorCanFrame(can_frame, _tx_error);
+        _SendBudgetedCanData(can_frame, CAN_TX_CLASS_RESPONSE, can_object->GetTxBudget(), time);
+    }
+
     /// @brief Sends data to the CAN bus with check if sending callback function is setted
     /// @param can_frame CAN frame data to send
     void _SendCanData(can_frame_t &can_frame)
     {
-        if (_send_func == nullptr || !can_frame.initialized)
+        if (!can_frame.initialized)
             return;
 
-        _send_func(can_frame.object_id, can_frame.raw_data, can_frame.raw_data_length);
+        if (!_SendRawData(can_frame.object_id, can_frame.raw_data, can_frame.raw_data_length))
+            return;
 
         clear_can_error_struct(_tx_error);
         clear_can_frame_struct(_tx_can_frame);
     }
 
+    /// @brief Sends the frame if TX budgets of the object and of the node have tokens for its traffic class.
+    ///        Otherwise the frame is deferred or dropped according to the policy of the exhausted budget.
+    /// @param can_frame CAN frame to send
+    /// @param tx_class Traffic class of the frame
+    /// @param object_budget TX budget of the object or nullptr if it is already checked (or isn't set)
+    /// @param time Current time
+    /// @return 'true' if the frame was sent, 'false' if it was deferred, dropped or isn't initialized
+    bool _SendBudgetedCanData(can_frame_t &can_frame, can_tx_class_t tx_class, CANTxBudget *object_budget, uint32_t time)
+    {
+        if (!can_frame.initialized)
+            return false;
+
+        if (tx_class != CAN_TX_CLASS_UNLIMITED)
+        {
+            CANTxBudget *exhausted_budget = nullptr;
+            if (object_budget != nullptr && !object_budget->HasToken(tx_class, time))
+                exhausted_budget = object_budget;
+            else if (_tx_budget != nullptr && !_tx_budget->HasToken(tx_class, time))
+                exhausted_budget = _tx_budget;
+
+            if (exhausted_budget != nullptr)
+            {
+                if (exhausted_budget->GetPolicy() == CAN_TX_BUDGET_POLICY_DEFER && _tx_deferred_count < CAN_TX_DEFERRED_QUEUE_SIZE)
+                {
+                    tx_deferred_frame_t &deferred = _tx_deferred[_tx_deferred_count++];
+                    copy_can_frame_struct(deferred.frame, can_frame);
+                    deferred.tx_class = tx_class;
+                    deferred.object_budget = object_budget;
+                    exhausted_budget->CountDeferred(tx_class);
+                }
+                else
+                {
+                    exhausted_budget->CountDropped(tx_class);
+                }
+                return false;
+            }
+
+            if (object_budget != nullptr)
+                object_budget->TakeToken(tx_class, time);
+            if (_tx_budget != nullptr)
+                _tx_budget->TakeToken(tx_class, time);
+        }
+
+        _SendCanData(can_frame);
+        return true;
+    }
+
+    /// @brief Sends deferred frames which got tokens of their budgets. The order of the other frames is kept.
+    /// @param time Current time
+    void _SendDeferredFrames(uint32_t time)
+    {
+        uint8_t kept = 0;
+        for (uint8_t i = 0; i < _tx_deferred_count; i++)
+        {
+            tx_deferred_frame_t &deferred = _tx_deferred[i];
+            if ((deferred.object_budget == nullptr || deferred.object_budget->HasToken(deferred.tx_class, time)) &&
+                (_tx_budget == nullptr || _tx_budget->HasToken(deferred.tx_class, time)))
+            {
+                if (deferred.object_budget != nullptr)
+                    deferred.object_budget->TakeToken(deferred.tx_class, time);
+                if (_tx_budget != nullptr)
+                    _tx_budget->TakeToken(deferred.tx_class, time);
+
+                _SendCanData(deferred.frame);
+                continue;
+            }
+
+            if (kept != i)
+                _tx_deferred[kept] = deferred;
+            kept++;
+        }
+        _tx_deferred_count = kept;
+    }
+
+    /// @brief Returns the traffic class of the automatic frame
+    /// @param function_id Function ID of the frame
+    /// @return Traffic class
+    static can_tx_class_t _GetFrameTxClass(can_function_id_t function_id)
+    {
+        switch (function_id)
+        {
+        case CAN_FUNC_TIMER_NORMAL:
+        case CAN_FUNC_TIMER_WARNING:
+        case CAN_FUNC_TIMER_CRITICAL:
+            return CAN_TX_CLASS_TIMER;
+
+        case CAN_FUNC_SET_REAL_TIME_IN:
+            return CAN_TX_CLASS_UNLIMITED;
+
+        default:
+            // error answers & events have the highest bit of the function ID set
+            return (function_id & 0x80) ? CAN_TX_CLASS_ERROR : CAN_TX_CLASS_EVENT;
+        }
+    }
+
+    /// @brief Passes raw frame data to the sending function or to the batch of outgoing frames
+    /// @param id CAN frame ID
+    /// @param data Frame data including function ID
+    /// @param length Frame data length including function ID
+    /// @return 'true' if the frame was sent or stored in the batch, 'false' if no sending function is registered
+    bool _SendRawData(can_object_id_t id, const uint8_t *data, uint8_t length)
+    {
+        if (_send_batch_func == nullptr && _send_fd_func == nullptr && _send_func == nullptr)
+            return false;
+
+        // classic controllers can't send long frames
+        if (length > CAN_CLASSIC_FRAME_MAX_LENGTH && _send_batch_func == nullptr && _send_fd_func == nullptr)
+            return false;
+
+        if (_capture != nullptr)
+            _capture->Capture(CAN_CAPTURE_DIRECTION_TX, _manager_id, id, data, length);
+
+        if (_send_batch_func != nullptr)
+        {
+            can_frame_t &batch_frame = _tx_batch[_tx_batch_count++];
+            batch_frame.object_id = id;
+            memcpy(batch_frame.raw_data, data, length);
+            batch_frame.raw_data_length = length;
+            batch_frame.initialized = true;
+            batch_frame.flags = _GetTxFrameFlags(length);
+            if (_tx_batch_count >= _tx_batch_size)
+                _FlushTxBatch();
+        }
+        else if (_send_fd_func != nullptr)
+        {
+            _send_fd_func(id, (uint8_t *)data, length, _GetTxFrameFlags(length));
+        }
+        else
+        {
+            // the sending function doesn't change the data
+            _send_func(id, (uint8_t *)data, length);
+        }
+
+        return true;
+    }
+
+    /// @brief Returns format flags of the outgoing frame
+    /// @param length Frame data length including function ID
+    /// @return Combination of can_frame_flags_t
+    uint8_t _GetTxFrameFlags(uint8_t length)
+    {
+        if (length > CAN_CLASSIC_FRAME_MAX_LENGTH)
+            return _fd_frame_flags | CAN_FRAME_FLAG_FDF;
+
+        return (_fd_frame_flags & CAN_FRAME_FLAG_FDF) ? _fd_frame_flags : (uint8_t)CAN_FRAME_FLAG_NONE;
+    }
+
+    /// @brief Passes all collected outgoing CAN frames to the batched sending function
+    void _FlushTxBatch()
+    {
+        if (_tx_batch_count == 0)
+            return;
+
+        if (_send_batch_func != nullptr)
+            _send_batch_func(_tx_batch, _tx_batch_count);
+
+        _tx_batch_count = 0;
+    }
+
     /// @brief Fills CAN frame with correct error data
     /// @param can_frame [OUT] CAN frame to fill
     /// @param error [IN] Error structure with error section and error code
@@ -347,6 +1458,102 @@ private:
         }
     }
 
+    /// @brief Fills the order of CANObjects processing for the current tick according to the scheduling policy
+    /// @param time Current time
+    void _BuildSchedule(uint32_t time)
+    {
+        switch (_scheduling_policy)
+        {
+        case CAN_SCHEDULING_ROUND_ROBIN:
+            if (_round_robin_offset >= _objects_idx)
+                _round_robin_offset = 0;
+
+            for (uint8_t i = 0; i < _objects_idx; i++)
+            {
+                _schedule[i] = (_round_robin_offset + i) % _objects_idx;
+            }
+            _round_robin_offset++;
+            break;
+
+        case CAN_SCHEDULING_STATIC_PRIORITY:
+            memcpy(_schedule, _objects_by_priority, _objects_idx);
+            break;
+
+        case CAN_SCHEDULING_EARLIEST_DEADLINE_FIRST:
+        {
+            // objects without active automatic functions go to the end of the schedule
+            int32_t time_left[_max_objects] = {0};
+            for (uint8_t i = 0; i < _objects_idx; i++)
+            {
+                uint32_t deadline = 0;
+                time_left[i] = _objects[i]->GetNextDeadline(time, deadline) ? (int32_t)(deadline - time) : INT32_MAX;
+            }
+
+            // insertion sort is stable and fast enough for the small number of objects
+            for (uint8_t i = 0; i < _objects_idx; i++)
+            {
+                uint8_t j = i;
+                while (j > 0 && time_left[_schedule[j - 1]] > time_left[i])
+                {
+                    _schedule[j] = _schedule[j - 1];
+                    j--;
+                }
+                _schedule[j] = i;
+            }
+            break;
+        }
+
+        case CAN_SCHEDULING_REGISTRATION_ORDER:
+        default:
+            for (uint8_t i = 0; i < _objects_idx; i++)
+            {
+                _schedule[i] = i;
+            }
+            break;
+        }
+    }
+
+    /// @brief Sorts indexes of registered CANObjects by their priority (stable, higher priority first)
+    void _SortObjectsByPriority()
+    {
+        for (uint8_t i = 0; i < _objects_idx; i++)
+        {
+            uint8_t j = i;
+            while (j > 0 && _objects_priority[_objects_by_priority[j - 1]] < _objects_priority[i])
+            {
+                _objects_by_priority[j] = _objects_by_priority[j - 1];
+                j--;
+            }
+            _objects_by_priority[j] = i;
+        }
+    }
+
+    /// @brief Updates statistics of CANObject after sending of automatic frame
+    /// @param obj_idx Index of the CANObject
+    /// @param time Current time
+    /// @param deadline The time when the sent function became due
+    void _UpdateObjectStats(uint8_t obj_idx, uint32_t time, uint32_t deadline)
+    {
+        can_object_stats_t &stats = _objects_stats[obj_idx];
+        uint32_t latency = ((int32_t)(time - deadline) > 0) ? time - deadline : 0;
+        if (latency > UINT16_MAX)
+            latency = UINT16_MAX;
+
+        stats.frames_sent++;
+        stats.latency_total_ms += latency;
+        stats.latency_last_ms = latency;
+        if (latency > stats.latency_max_ms)
+            stats.latency_max_ms = latency;
+    }
+
+    /// @brief Checks if the timer of CANObject is enabled
+    /// @param can_object CANObject to check
+    /// @return 'true' if the timer is enabled, 'false' if it is not.
+    static bool _HasTimerEnabled(CANObjectInterface &can_object)
+    {
+        return can_object.GetTimerPeriod() != CAN_TIMER_DISABLED && can_object.GetTimerPeriod() > 0;
+    }
+
     /// @brief Checks if specified CAN function is allowed in broadcast mode
     /// @param func_id CAN function ID for check
     /// @return 'true' if CAN function is allowed, 'false' if it is not.
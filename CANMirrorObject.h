@@ -0,0 +1,263 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include "CAN_common.h"
+#include "CAN_wire.h"
+
+/******************************************************************************************
+ *
+ ******************************************************************************************/
+class CANMirrorObjectInterface
+{
+public:
+    virtual ~CANMirrorObjectInterface() = default;
+
+    /// @brief Returns ID of the remote CANObject
+    /// @return ID of the remote CANObject
+    virtual can_object_id_t GetId() = 0;
+
+    /// @brief Updates the local copy of remote CANObject data from the passing CAN frame.
+    ///        Only CAN_FUNC_TIMER_* and CAN_FUNC_EVENT_OK frames are used.
+    /// @param can_frame Incoming CAN frame
+    /// @return 'true' if the data was updated, 'false' if the frame was ignored
+    virtual bool UpdateFromCanFrame(can_frame_t &can_frame) = 0;
+
+    /// @brief Checks whether the CAN function carries the data of the remote CANObject
+    /// @param function_id CAN function ID
+    /// @return 'true' if the frames with this function are used for updates
+    virtual bool IsMirroredFunction(can_function_id_t function_id) = 0;
+
+    /// @brief Checks whether at least one update was received
+    /// @return 'true' if the data was received at least once
+    virtual bool HasData() = 0;
+
+    /// @brief Returns the time of the last update
+    /// @return Time of the last update in milliseconds
+    virtual uint32_t GetLastUpdateTime() = 0;
+
+    /// @brief Returns the age of the local copy
+    /// @param time Current time
+    /// @return Time since the last update in milliseconds. UINT32_MAX if there was no update.
+    virtual uint32_t GetAge(uint32_t time) = 0;
+
+    /// @brief Sets the maximum age of the local copy
+    /// @param timeout_ms Maximum age in milliseconds. 0 means that the data never becomes stale.
+    /// @return CANMirrorObjectInterface reference
+    virtual CANMirrorObjectInterface &SetStaleTimeout(uint32_t timeout_ms) = 0;
+
+    /// @brief Checks whether the local copy is stale
+    /// @param time Current time
+    /// @return 'true' if there was no update or the data is older than the stale timeout
+    virtual bool IsStale(uint32_t time) = 0;
+
+    /// @brief Returns the timer level of the last timer frame
+    /// @return Timer type. CAN_TIMER_TYPE_NONE if no timer frames were received.
+    virtual timer_type_t GetTimerType() = 0;
+
+    /// @brief Returns CAN function ID of the last update frame
+    /// @return CAN function ID
+    virtual can_function_id_t GetLastFunctionId() = 0;
+
+    /// @brief Returns number of data fields in the mirror object
+    /// @return Returns number of data fields in the mirror object
+    virtual uint8_t GetDataFieldCount() = 0;
+
+    /// @brief Returns size of the mirror object's one data field item
+    /// @return Returns size of the mirror object's one data field item
+    virtual uint8_t GetOneDataFieldSize() = 0;
+
+    /// @brief Universal getter for mirror object's data fields
+    /// @param index Index of data field to get value from. If the index is out of range, nullpointer will be returned.
+    /// @return Pointer to the data field value. If the index is out of range, nullpointer will be returned.
+    virtual void *GetValuePtr(uint8_t index) = 0;
+};
+
+/******************************************************************************************
+ *
+ ******************************************************************************************/
+/// @brief Local cache of the remote CANObject. It decodes passing timer and event frames of the remote object,
+///        so the gateway can read the values without request frames.
+/// @tparam T Data field type, the same as in the remote CANObject
+/// @tparam _item_count The number of data fields, the same as in the remote CANObject
+template <typename T, uint8_t _item_count = 1>
+class CANMirrorObject : public CANMirrorObjectInterface
+{
+    static_assert(_item_count > 0);                                  // 0 data fields isn't allowed
+    static_assert(_item_count * sizeof(T) <= CAN_FRAME_MAX_PAYLOAD); // static data size validation (to fit it into the can frame)
+public:
+    /// @brief Default constructor is forbidden.
+    CANMirrorObject() = delete;
+
+    /// @brief Constructor of the mirror object
+    /// @param id ID of the remote CANObject
+    /// @param stale_timeout_ms Maximum age of the data. 0 means that the data never becomes stale.
+    CANMirrorObject(can_object_id_t id, uint32_t stale_timeout_ms = 0)
+        : _id(id), _stale_timeout(stale_timeout_ms){};
+
+    virtual ~CANMirrorObject() = default;
+
+    /// @brief Returns ID of the remote CANObject
+    /// @return ID of the remote CANObject
+    virtual can_object_id_t GetId() override
+    {
+        return _id;
+    };
+
+    /// @brief Updates the local copy of remote CANObject data from the passing CAN frame.
+    ///        Only CAN_FUNC_TIMER_* and CAN_FUNC_EVENT_OK frames are used.
+    /// @param can_frame Incoming CAN frame
+    /// @return 'true' if the data was updated, 'false' if the frame was ignored
+    virtual bool UpdateFromCanFrame(can_frame_t &can_frame) override
+    {
+        if (!can_frame.initialized ||
+            can_frame.object_id != _id ||
+            !IsMirroredFunction(can_frame.function_id) ||
+            !can_is_frame_length_matched(can_frame.raw_data_length, sizeof(_data_fields) + 1))
+            return false;
+
+        can_wire_decode(_data_fields, can_frame.data, _item_count);
+        switch (can_frame.function_id)
+        {
+        case CAN_FUNC_TIMER_NORMAL:
+            _timer_type = CAN_TIMER_TYPE_NORMAL;
+            break;
+
+        case CAN_FUNC_TIMER_WARNING:
+            _timer_type = CAN_TIMER_TYPE_WARNING;
+            break;
+
+        case CAN_FUNC_TIMER_CRITICAL:
+            _timer_type = CAN_TIMER_TYPE_CRITICAL;
+            break;
+
+        default:
+            // event frames don't carry the timer level
+            break;
+        }
+        _last_function_id = can_frame.function_id;
+        _last_update_time = can_frame.time_ms;
+        _has_data = true;
+
+        return true;
+    };
+
+    /// @brief Checks whether the CAN function carries the data of the remote CANObject
+    /// @param function_id CAN function ID
+    /// @return 'true' if the frames with this function are used for updates
+    virtual bool IsMirroredFunction(can_function_id_t function_id) override
+    {
+        return function_id == CAN_FUNC_TIMER_NORMAL ||
+               function_id == CAN_FUNC_TIMER_WARNING ||
+               function_id == CAN_FUNC_TIMER_CRITICAL ||
+               function_id == CAN_FUNC_EVENT_OK;
+    };
+
+    /// @brief Checks whether at least one update was received
+    /// @return 'true' if the data was received at least once
+    virtual bool HasData() override
+    {
+        return _has_data;
+    };
+
+    /// @brief Returns the time of the last update
+    /// @return Time of the last update in milliseconds
+    virtual uint32_t GetLastUpdateTime() override
+    {
+        return _last_update_time;
+    };
+
+    /// @brief Returns the age of the local copy
+    /// @param time Current time
+    /// @return Time since the last update in milliseconds. UINT32_MAX if there was no update.
+    virtual uint32_t GetAge(uint32_t time) override
+    {
+        if (!_has_data)
+            return UINT32_MAX;
+
+        return time - _last_update_time;
+    };
+
+    /// @brief Sets the maximum age of the local copy
+    /// @param timeout_ms Maximum age in milliseconds. 0 means that the data never becomes stale.
+    /// @return CANMirrorObjectInterface reference
+    virtual CANMirrorObjectInterface &SetStaleTimeout(uint32_t timeout_ms) override
+    {
+        _stale_timeout = timeout_ms;
+
+        return *this;
+    };
+
+    /// @brief Checks whether the local copy is stale
+    /// @param time Current time
+    /// @return 'true' if there was no update or the data is older than the stale timeout
+    virtual bool IsStale(uint32_t time) override
+    {
+        if (!_has_data)
+            return true;
+
+        return _stale_timeout != 0 && GetAge(time) > _stale_timeout;
+    };
+
+    /// @brief Returns the timer level of the last timer frame
+    /// @return Timer type. CAN_TIMER_TYPE_NONE if no timer frames were received.
+    virtual timer_type_t GetTimerType() override
+    {
+        return _timer_type;
+    };
+
+    /// @brief Returns CAN function ID of the last update frame
+    /// @return CAN function ID
+    virtual can_function_id_t GetLastFunctionId() override
+    {
+        return _last_function_id;
+    };
+
+    /// @brief Returns number of data fields in the mirror object
+    /// @return Returns number of data fields in the mirror object
+    virtual uint8_t GetDataFieldCount() override
+    {
+        return _item_count;
+    };
+
+    /// @brief Returns size of the mirror object's one data field item
+    /// @return Returns size of the mirror object's one data field item
+    virtual uint8_t GetOneDataFieldSize() override
+    {
+        return sizeof(T);
+    };
+
+    /// @brief Universal getter for mirror object's data fields
+    /// @param index Index of data field to get value from. If the index is out of range, nullpointer will be returned.
+    /// @return Pointer to the data field value. If the index is out of range, nullpointer will be returned.
+    virtual void *GetValuePtr(uint8_t index) override
+    {
+        if (index >= _item_count)
+            return nullptr;
+
+        return (void *)&_data_fields[index];
+    };
+
+    /// @brief The variation of GetValue() method, which returns typed value.
+    /// @param index Index of data field to get value from.
+    /// @return The value of the specified data field. If the index is out of range, zero value will be returned.
+    T GetValue(uint8_t index)
+    {
+        if (index >= _item_count)
+            return (T)0;
+
+        return _data_fields[index];
+    }
+
+private:
+    can_object_id_t _id = 0;
+
+    // local copy of the remote data
+    T _data_fields[_item_count] = {0};
+
+    uint32_t _last_update_time = 0;
+    uint32_t _stale_timeout = 0;
+    bool _has_data = false;
+    timer_type_t _timer_type = CAN_TIMER_TYPE_NONE;
+    can_function_id_t _last_function_id = CAN_FUNC_NONE;
+};
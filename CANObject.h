@@ -3,6 +3,45 @@
 #include <stdint.h>
 #include <string.h>
 #include "CAN_common.h"
+#include "CAN_wire.h"
+#include "CANTxBudget.h"
+#include "CANProfiler.h"
+
+#ifndef CAN_OBJECT_MAX_CUSTOM_FUNCTIONS
+#define CAN_OBJECT_MAX_CUSTOM_FUNCTIONS 2 // the number of custom incoming functions per CANObject
+#endif
+
+#ifndef CAN_OBJECT_LEGACY_HANDLERS
+// 0 removes RegisterFunctionXXX() handlers without context (saves 9 pointers per CANObject).
+// The handler table pointer is always there, so handler tables save RAM only with 0.
+#define CAN_OBJECT_LEGACY_HANDLERS 1
+#endif
+
+class CANObjectInterface;
+
+using object_function_handler_t = can_result_t (*)(CANObjectInterface &object, can_frame_t &can_frame, can_error_t &error, void *context);
+using object_event_handler_t = can_result_t (*)(CANObjectInterface &object, can_frame_t &can_frame, event_type_t event_type, can_error_t &error, void *context);
+using object_timer_handler_t = can_result_t (*)(CANObjectInterface &object, can_frame_t &can_frame, timer_type_t timer_type, can_error_t &error, void *context);
+using object_realtime_error_handler_t = void (*)(CANObjectInterface &object, uint32_t time_has_passed_ms, void *context);
+using object_custom_lookup_t = object_function_handler_t (*)(can_function_id_t function_id);
+
+// Table of context-aware handlers. One constant table can be shared by many CANObjects:
+// every handler gets the object which calls it and the user context, so one handler serves a whole family of objects.
+// nullptr handlers are treated as missing ones.
+struct can_handler_table_t
+{
+    void *context;                                      // user data passed to every handler
+    object_event_handler_t event;                       // see RegisterFunctionEvent()
+    object_timer_handler_t timer;                       // see RegisterFunctionTimer()
+    object_function_handler_t set;                      // see RegisterFunctionSet()
+    object_function_handler_t set_realtime;             // see RegisterFunctionSetRealtime()
+    object_realtime_error_handler_t set_realtime_error; // see RegisterFunctionSetRealtime()
+    object_function_handler_t lock;                     // see RegisterFunctionLock()
+    object_function_handler_t request;                  // see RegisterFunctionRequest()
+    object_function_handler_t toggle;                   // see RegisterFunctionToggle()
+    object_function_handler_t action;                   // see RegisterFunctionAction()
+    object_custom_lookup_t custom;                      // handler of the custom function ID or nullptr, see RegisterFunctionCustom()
+};
 
 /******************************************************************************************
  *
@@ -12,6 +51,7 @@ class CANObjectInterface
 public:
     virtual ~CANObjectInterface() = default;
 
+#if CAN_OBJECT_LEGACY_HANDLERS
     /// @brief Registers an external handler for events. It will be called when event occurs.
     /// @param event_handler Pointer to the event handler.
     /// @param error_delay_ms Delay for the error events in milliseconds.
@@ -22,6 +62,7 @@ public:
     /// @param event_handler Pointer to the event handler.
     /// @return CANObjectInterface reference
     virtual CANObjectInterface &RegisterFunctionEvent(event_handler_t event_handler) = 0;
+#endif
 
     /// @brief Sets the value of error events resending delay.
     /// @param delay_ms Delay for the error evends in milliseconds.
@@ -37,15 +78,18 @@ public:
     /// @return 'true' if the external handler exists, `false` if not
     virtual bool HasExternalFunctionEvent() = 0;
 
+#if CAN_OBJECT_LEGACY_HANDLERS
     /// @brief Registers an external handler for set commands. It will be called when set command comes.
     /// @param set_handler Pointer to the set command handler.
     /// @return CANObjectInterface reference
     virtual CANObjectInterface &RegisterFunctionSet(set_handler_t set_handler) = 0;
+#endif
 
     /// @brief Checks whether the external set function handler is set.
     /// @return 'true' if the external handler exists, `false` if not
     virtual bool HasExternalFunctionSet() = 0;
 
+#if CAN_OBJECT_LEGACY_HANDLERS
     /// @brief Register an external handler for set real-time commands. It will be called when set_realtime command comes.
     /// @param set_realtime_handler Pointer to the set real-time external handler.
     /// @param error_handler Pointer to the external error handler
@@ -62,6 +106,7 @@ public:
     /// @param error_handler Pointer to the external error handler
     /// @return CANObjectInterface reference
     virtual CANObjectInterface &RegisterFunctionSetRealtime(set_realtime_handler_t set_realtime_handler, set_realtime_error_handler_t error_handler) = 0;
+#endif
 
     /// @brief Sets the interval between CAN frames in milliseconds for real-time data.
     /// @param data_interval_ms The interval in milliseconds.
@@ -72,6 +117,25 @@ public:
     /// @return Real-time data interval.
     virtual uint16_t GetRealtimeDataInterval() = 0;
 
+    /// @brief Enables adaptive sending of real-time data. The frame is sent as soon as the value changes by the threshold
+    ///        (but not more often than the data interval); while the value is steady, the interval doubles up to the maximum.
+    ///        Every frame carries the interval to the next frame, so silent listeners adjust their data timeout.
+    ///        Listeners built before the adaptive mode ignore the interval and time out after 1.5 data intervals:
+    ///        enable it only when all listeners of the object are updated.
+    /// @param max_interval_ms The maximum interval in milliseconds. 0 disables the adaptive mode.
+    /// @param change_threshold Pointer to the minimal change of the value which is sent at once.
+    /// @return CANObjectInterface reference
+    virtual CANObjectInterface &SetRealtimeAdaptive(uint16_t max_interval_ms, void *change_threshold) = 0;
+
+    /// @brief Returns the maximum interval of adaptive real-time sending.
+    /// @return The maximum interval, 0 if the adaptive mode is disabled.
+    virtual uint16_t GetRealtimeMaxInterval() = 0;
+
+    /// @brief Returns the current real-time interval: the interval to the next frame of the sender object
+    ///        or the interval advertised by the sender for the silent object.
+    /// @return The current interval in milliseconds.
+    virtual uint16_t GetRealtimeCurrentInterval() = 0;
+
     /// @brief Sets zero point for real-time data.
     /// @param data_zero_point Pointer to the data zero point.
     /// @return CANObjectInterface reference
@@ -109,6 +173,7 @@ public:
     /// @return Last real-time CAN frame ID.
     virtual uint8_t GetRealtimeLastFrameId() = 0;
 
+#if CAN_OBJECT_LEGACY_HANDLERS
     /// @brief Registers an external handler for timer. It will be called when timer occurs.
     /// @param timer_handler Pointer to the timer handler.
     /// @param period_ms Timer's period in milliseconds.
@@ -124,6 +189,7 @@ public:
     /// @param timer_handler Pointer to the timer handler.
     /// @return CANObjectInterface reference
     virtual CANObjectInterface &RegisterFunctionTimer(timer_handler_t timer_handler) = 0;
+#endif
 
     /// @brief Sets the value of timer's period.
     /// @param period_ms Timer's period in milliseconds.
@@ -136,46 +202,84 @@ public:
     /// @return CANObjectInterface reference
     virtual CANObjectInterface &SetTimerFloodMode(bool flood_mode) = 0;
 
+    /// @brief Sets the phase offset of the timer inside its period. It spreads timers of different objects
+    ///        with the same period over time, so they are not fired in the same tick.
+    ///        By default the phase is calculated from the object ID.
+    /// @param phase_ms Phase offset in milliseconds. It is reduced modulo timer's period.
+    /// @return CANObjectInterface reference
+    virtual CANObjectInterface &SetTimerPhase(uint16_t phase_ms) = 0;
+
     /// @brief Checks whether the external timer function handler is set.
     /// @return 'true' if the external handler exists, `false` if not
     virtual bool HasExternalFunctionTimer() = 0;
 
+#if CAN_OBJECT_LEGACY_HANDLERS
     /// @brief Registers an external handler for lock commands. It will be called when lock command comes.
     /// @param lock_handler Pointer to the lock command handler.
     /// @return CANObjectInterface reference
     virtual CANObjectInterface &RegisterFunctionLock(lock_handler_t lock_handler) = 0;
+#endif
 
     /// @brief Checks whether the external lock function handler is set.
     /// @return 'true' if the external handler exists, `false` if not
     virtual bool HasExternalFunctionLock() = 0;
 
+#if CAN_OBJECT_LEGACY_HANDLERS
     /// @brief Registers an external handler for request commands. It will be called when request command comes.
     /// @param request_handler Pointer to the request command handler.
     /// @return CANObjectInterface reference
     virtual CANObjectInterface &RegisterFunctionRequest(request_handler_t request_handler) = 0;
+#endif
 
     /// @brief Checks whether the external request function handler is set.
     /// @return 'true' if the external handler exists, `false` if not
     virtual bool HasExternalFunctionRequest() = 0;
 
+#if CAN_OBJECT_LEGACY_HANDLERS
     /// @brief Registers an external handler for toggle commands. It will be called when toggle command comes.
     /// @param toggle_handler Pointer to the toggle command handler.
     /// @return CANObjectInterface reference
     virtual CANObjectInterface &RegisterFunctionToggle(toggle_handler_t toggle_handler) = 0;
+#endif
 
     /// @brief Checks whether the external toggle function handler is set.
     /// @return 'true' if the external handler exists, `false` if not
     virtual bool HasExternalFunctionToggle() = 0;
 
+#if CAN_OBJECT_LEGACY_HANDLERS
     /// @brief Registers an external handler for action commands. It will be called when action command comes.
     /// @param action_handler Pointer to the action command handler.
     /// @return CANObjectInterface reference
     virtual CANObjectInterface &RegisterFunctionAction(action_handler_t action_handler) = 0;
+#endif
 
     /// @brief Checks whether the external action function handler is set.
     /// @return 'true' if the external handler exists, `false` if not
     virtual bool HasExternalFunctionAction() = 0;
 
+    /// @brief Registers an external handler for the custom incoming function. Free IN function IDs only can be used
+    ///        (IDs below CAN_FUNC_FIRST_OUT_OK which are not used by the protocol).
+    ///        Registered handlers take precedence over the custom handlers of the handler table.
+    /// @param function_id Custom function ID.
+    /// @param custom_handler Pointer to the handler. nullptr removes the handler.
+    /// @return 'true' if the handler was registered, 'false' if the ID is reserved or all slots are used
+    virtual bool RegisterFunctionCustom(can_function_id_t function_id, custom_handler_t custom_handler) = 0;
+
+    /// @brief Checks whether the external handler of the custom function is set.
+    /// @param function_id Custom function ID.
+    /// @return 'true' if the external handler exists, `false` if not
+    virtual bool HasExternalFunctionCustom(can_function_id_t function_id) = 0;
+
+    /// @brief Sets the table of context-aware handlers. The table isn't copied, it can be shared by many objects.
+    ///        Legacy handlers registered by RegisterFunctionXXX() take precedence over the handlers of the table.
+    /// @param handler_table Pointer to the table. nullptr removes the table.
+    /// @return CANObjectInterface reference
+    virtual CANObjectInterface &SetHandlerTable(const can_handler_table_t *handler_table) = 0;
+
+    /// @brief Returns the table of context-aware handlers.
+    /// @return Pointer to the table or nullptr if it isn't set
+    virtual const can_handler_table_t *GetHandlerTable() = 0;
+
     /// @brief Sets type of object.
     /// @param object_type type of the object ot set.
     /// @return CANObjectInterface reference
@@ -188,12 +292,61 @@ public:
     /// @return The result of CANObject processing (should we send any CAN frames or not)
     virtual can_result_t Process(uint32_t time, can_frame_t &can_frame, can_error_t &error) = 0;
 
+    /// @brief Returns the time when the earliest automatic function of the object is (or was) due.
+    /// @param time Current time
+    /// @param deadline [OUT] The time of the earliest due automatic function. It can be in the past if the function is overdue.
+    /// @return 'true' if the object has any active automatic function, 'false' if not.
+    virtual bool GetNextDeadline(uint32_t time, uint32_t &deadline) = 0;
+
+    /// @brief Sets the maximum number of frames which can be produced by Process() during one tick.
+    ///        Due automatic functions above the limit are postponed to the next tick and counted as deferred.
+    /// @param max_frames The number of frames, at least 1.
+    /// @return CANObjectInterface reference
+    virtual CANObjectInterface &SetMaxFramesPerTick(uint8_t max_frames) = 0;
+
+    /// @brief Returns the maximum number of frames which can be produced by Process() during one tick.
+    /// @return The number of frames.
+    virtual uint8_t GetMaxFramesPerTick() = 0;
+
+    /// @brief Returns the number of automatic frames which were postponed because of the frames per tick limit.
+    /// @return The number of deferred frames since the object creation.
+    virtual uint32_t GetDeferredFramesCount() = 0;
+
+    /// @brief Attaches the TX budget to the object. Automatic functions over the budget are deferred or dropped
+    ///        according to the budget policy, answers to incoming frames are limited by CANManager.
+    /// @param tx_budget Pointer to the budget. nullptr removes the limits.
+    /// @return CANObjectInterface reference
+    virtual CANObjectInterface &SetTxBudget(CANTxBudget *tx_budget) = 0;
+
+    /// @brief Returns the TX budget of the object
+    /// @return Pointer to the budget or nullptr if the object isn't limited
+    virtual CANTxBudget *GetTxBudget() = 0;
+
+    /// @brief Attaches the profiler which measures execution time of handlers and automatic functions of the object.
+    /// @param profiler Pointer to the profiler. nullptr disables profiling.
+    /// @return CANObjectInterface reference
+    virtual CANObjectInterface &SetProfiler(CANProfilerInterface *profiler) = 0;
+
+    /// @brief Returns the profiler of the object
+    /// @return Pointer to the profiler or nullptr if the object isn't profiled
+    virtual CANProfilerInterface *GetProfiler() = 0;
+
     /// @brief Process incoming CAN frame
     /// @param can_frame [OUT] CAN frame for processing
     /// @param error [OUT] An outgoing error structure. It will be filled by object if something went wrong.
     /// @return The result of incoming can frame processing (should we send any CAN frames or not)
     virtual can_result_t InputCanFrame(can_frame_t &can_frame, can_error_t &error) = 0;
 
+    /// @brief Checks incoming frame before CANManager stores it in the buffer (IncomingCANFrame() may be called from ISR).
+    ///        The check uses precomputed bitmap of accepted functions and length rules and doesn't change the object.
+    /// @param data Frame data including function ID
+    /// @param length Frame data length including function ID
+    /// @param check_lock 'false' if the lock level may change before the frame is processed (LOCK frames are in the buffer)
+    /// @param error [OUT] Error answer required by the protocol for the rejected frame
+    /// @return CAN_RESULT_CAN_FRAME if the frame should be stored, CAN_RESULT_ERROR if the frame should be answered with the error,
+    ///         CAN_RESULT_IGNORE if the frame should be dropped silently
+    virtual can_result_t ValidateIncomingFrame(const uint8_t *data, uint8_t length, bool check_lock, can_error_t &error) = 0;
+
     /// @brief Fills CAN frame from the object with specified data
     /// @param can_frame [OUT] CAN frame for processing
     /// @param error [OUT] An outgoing error structure. It will be filled by object if something went wrong.
@@ -215,6 +368,10 @@ public:
     /// @return Timer's period in milliseconds.
     virtual uint16_t GetTimerPeriod() = 0;
 
+    /// @brief Returns the phase offset of the timer.
+    /// @return Timer's phase offset in milliseconds.
+    virtual uint16_t GetTimerPhase() = 0;
+
     /// @brief Return the timer's mode.
     /// @return 'true' if timer works in flood mode, 'false' if timer works in frame limit mode.
     virtual bool IsTimerInFloodMode() = 0;
@@ -277,7 +434,7 @@ template <typename T, uint8_t _item_count = 1>
 class CANObject : public CANObjectInterface
 {
     static_assert(_item_count > 0);              // 0 data fields isn't allowed
-    static_assert(_item_count * sizeof(T) <= 7); // static data size validation (to fit it into the can frame)
+    static_assert(_item_count * sizeof(T) <= CAN_FRAME_MAX_PAYLOAD); // static data size validation (to fit it into the can frame)
 public:
     /// @brief Default constructor is forbidden.
     CANObject() = delete;
@@ -298,6 +455,8 @@ public:
         : _id(id), _timer_period(timer_period_ms), _error_period(error_period_ms), _flood_mode(flood_mode), _object_type(object_type)
     {
         ClearDataFields();
+        _UpdateAcceptedFunctions();
+        _ApplyTimerPhase(_GetIdBasedTimerPhase());
     };
 
     virtual ~CANObject() = default;
@@ -337,6 +496,7 @@ public:
         return CAN_TIMER_TYPE_CRITICAL;
     }
 
+#if CAN_OBJECT_LEGACY_HANDLERS
     /// @brief Registers an external handler for events. It will be called when event occurs.
     /// @param event_handler Pointer to the event handler.
     /// @param error_delay_ms Delay for the error evends in milliseconds.
@@ -358,6 +518,7 @@ public:
 
         return *this;
     };
+#endif
 
     /// @brief Sets the value of error events resending delay.
     /// @param delay_ms Delay for the error evends in milliseconds.
@@ -383,26 +544,38 @@ public:
     /// @return 'true' if the external handler exists, `false` if not
     virtual bool HasExternalFunctionEvent() override
     {
-        return _event_handler != nullptr;
+#if CAN_OBJECT_LEGACY_HANDLERS
+        if (_event_handler != nullptr)
+            return true;
+#endif
+        return _handler_table != nullptr && _handler_table->event != nullptr;
     };
 
+#if CAN_OBJECT_LEGACY_HANDLERS
     /// @brief Registers an external handler for set commands. It will be called when set command comes.
     /// @param set_handler Pointer to the set command handler.
     /// @return CANObjectInterface reference
     virtual CANObjectInterface &RegisterFunctionSet(set_handler_t set_handler) override
     {
         _set_handler = set_handler;
+        _UpdateAcceptedFunctions();
 
         return *this;
     };
+#endif
 
     /// @brief Checks whether the external set function handler is set.
     /// @return 'true' if the external handler exists, `false` if not
     virtual bool HasExternalFunctionSet() override
     {
-        return _set_handler != nullptr;
+#if CAN_OBJECT_LEGACY_HANDLERS
+        if (_set_handler != nullptr)
+            return true;
+#endif
+        return _handler_table != nullptr && _handler_table->set != nullptr;
     };
 
+#if CAN_OBJECT_LEGACY_HANDLERS
     /// @brief Register an external handler for set realtime commands. It will be called when set_realtime command comes.
     /// @param set_realtime_handler Pointer to the set realtime external handler.
     /// @param error_handler Pointer to the external error handler.
@@ -435,9 +608,11 @@ public:
     {
         _set_realtime_handler = set_realtime_handler;
         _set_realtime_error_handler = error_handler;
+        _UpdateAcceptedFunctions();
 
         return *this;
     };
+#endif
 
     /// @brief Sets the interval between CAN frames in milliseconds for realtime data.
     /// @param data_interval_ms The interval in milliseconds.
@@ -445,6 +620,7 @@ public:
     virtual CANObjectInterface &SetRealtimeDataInterval(uint16_t data_interval_ms) override
     {
         _realtime_frame_interval = data_interval_ms;
+        _realtime_current_interval = 0;
 
         return *this;
     };
@@ -456,6 +632,40 @@ public:
         return _realtime_frame_interval;
     };
 
+    /// @brief Enables adaptive sending of real-time data. The frame is sent as soon as the value changes by the threshold
+    ///        (but not more often than the data interval); while the value is steady, the interval doubles up to the maximum.
+    ///        Every frame carries the interval to the next frame, so silent listeners adjust their data timeout.
+    ///        Listeners built before the adaptive mode ignore the interval and time out after 1.5 data intervals:
+    ///        enable it only when all listeners of the object are updated.
+    ///        The interval is sent if the value and the interval fit into the frame: sizeof(T) + 3 <= CAN_FRAME_MAX_PAYLOAD.
+    /// @param max_interval_ms The maximum interval in milliseconds. 0 disables the adaptive mode.
+    /// @param change_threshold Pointer to the minimal change of the value which is sent at once. nullptr means any change.
+    /// @return CANObjectInterface reference
+    virtual CANObjectInterface &SetRealtimeAdaptive(uint16_t max_interval_ms, void *change_threshold) override
+    {
+        _realtime_max_interval = max_interval_ms;
+        _realtime_change_threshold = (change_threshold != nullptr) ? *(T *)change_threshold : (T)0;
+        _realtime_current_interval = 0;
+        _realtime_change_pending = false;
+
+        return *this;
+    };
+
+    /// @brief Returns the maximum interval of adaptive real-time sending.
+    /// @return The maximum interval, 0 if the adaptive mode is disabled.
+    virtual uint16_t GetRealtimeMaxInterval() override
+    {
+        return _realtime_max_interval;
+    };
+
+    /// @brief Returns the current real-time interval: the interval to the next frame of the sender object
+    ///        or the interval advertised by the sender for the silent object.
+    /// @return The current interval in milliseconds.
+    virtual uint16_t GetRealtimeCurrentInterval() override
+    {
+        return _GetRealtimeInterval();
+    };
+
     /// @brief Sets zero point for real-time data.
     /// @param data_zero_point Pointer to the data zero point.
     /// @return CANObjectInterface reference
@@ -494,7 +704,11 @@ public:
     /// @return 'true' if the external handler exists, `false` if not
     virtual bool HasExternalFunctionSetRealtime() override
     {
-        return _set_realtime_handler != nullptr && _set_realtime_error_handler != nullptr;
+#if CAN_OBJECT_LEGACY_HANDLERS
+        if (_set_realtime_handler != nullptr && _set_realtime_error_handler != nullptr)
+            return true;
+#endif
+        return _handler_table != nullptr && _handler_table->set_realtime != nullptr && _handler_table->set_realtime_error != nullptr;
     };
 
     /// @brief Checks error state of silent real-time object
@@ -525,6 +739,7 @@ public:
         return _realtime_frame_id;
     };
 
+#if CAN_OBJECT_LEGACY_HANDLERS
     /// @brief Registers an external handler for timer. It will be called when timer occurs.
     /// @param timer_handler Pointer to the timer handler.
     /// @param period_ms Timer's period in milliseconds.
@@ -552,6 +767,7 @@ public:
 
         return *this;
     };
+#endif
 
     /// @brief Sets the value of timer's period.
     /// @param period_ms Timer's period in milliseconds.
@@ -559,6 +775,7 @@ public:
     virtual CANObjectInterface &SetTimerPeriod(uint16_t period_ms) override
     {
         _timer_period = period_ms;
+        _ApplyTimerPhase(_timer_phase_is_auto ? _GetIdBasedTimerPhase() : _timer_phase);
 
         return *this;
     };
@@ -574,13 +791,31 @@ public:
         return *this;
     };
 
+    /// @brief Sets the phase offset of the timer inside its period. It spreads timers of different objects
+    ///        with the same period over time, so they are not fired in the same tick.
+    ///        By default the phase is calculated from the object ID.
+    /// @param phase_ms Phase offset in milliseconds. It is reduced modulo timer's period.
+    /// @return CANObjectInterface reference
+    virtual CANObjectInterface &SetTimerPhase(uint16_t phase_ms) override
+    {
+        _timer_phase_is_auto = false;
+        _ApplyTimerPhase(phase_ms);
+
+        return *this;
+    };
+
     /// @brief Checks whether the external timer function handler is set.
     /// @return 'true' if the external handler exists, `false` if not
     virtual bool HasExternalFunctionTimer() override
     {
-        return _timer_handler != nullptr;
+#if CAN_OBJECT_LEGACY_HANDLERS
+        if (_timer_handler != nullptr)
+            return true;
+#endif
+        return _handler_table != nullptr && _handler_table->timer != nullptr;
     };
 
+#if CAN_OBJECT_LEGACY_HANDLERS
     /// @brief Registers an external handler for lock commands. It will be called when lock command comes.
     /// @param lock_handler Pointer to the lock command handler.
     /// @return CANObjectInterface reference
@@ -590,14 +825,20 @@ public:
 
         return *this;
     };
+#endif
 
     /// @brief Checks whether the external lock function handler is set.
     /// @return 'true' if the external handler exists, `false` if not
     virtual bool HasExternalFunctionLock() override
     {
-        return _lock_handler != nullptr;
+#if CAN_OBJECT_LEGACY_HANDLERS
+        if (_lock_handler != nullptr)
+            return true;
+#endif
+        return _handler_table != nullptr && _handler_table->lock != nullptr;
     };
 
+#if CAN_OBJECT_LEGACY_HANDLERS
     /// @brief Registers an external handler for request commands. It will be called when request command comes.
     /// @param request_handler Pointer to the request command handler.
     /// @return CANObjectInterface reference
@@ -607,46 +848,127 @@ public:
 
         return *this;
     };
+#endif
 
     /// @brief Checks whether the external request function handler is set.
     /// @return 'true' if the external handler exists, `false` if not
     virtual bool HasExternalFunctionRequest() override
     {
-        return _request_handler != nullptr;
+#if CAN_OBJECT_LEGACY_HANDLERS
+        if (_request_handler != nullptr)
+            return true;
+#endif
+        return _handler_table != nullptr && _handler_table->request != nullptr;
     };
 
+#if CAN_OBJECT_LEGACY_HANDLERS
     /// @brief Registers an external handler for toggle commands. It will be called when toggle command comes.
     /// @param toggle_handler Pointer to the toggle command handler.
     /// @return CANObjectInterface reference
     virtual CANObjectInterface &RegisterFunctionToggle(toggle_handler_t toggle_handler) override
     {
         _toggle_handler = toggle_handler;
+        _UpdateAcceptedFunctions();
 
         return *this;
     };
+#endif
 
     /// @brief Checks whether the external toggle function handler is set.
     /// @return 'true' if the external handler exists, `false` if not
     virtual bool HasExternalFunctionToggle() override
     {
-        return _toggle_handler != nullptr;
+#if CAN_OBJECT_LEGACY_HANDLERS
+        if (_toggle_handler != nullptr)
+            return true;
+#endif
+        return _handler_table != nullptr && _handler_table->toggle != nullptr;
     };
 
+#if CAN_OBJECT_LEGACY_HANDLERS
     /// @brief Registers an external handler for action commands. It will be called when action command comes.
     /// @param action_handler Pointer to the action command handler.
     /// @return CANObjectInterface reference
     virtual CANObjectInterface &RegisterFunctionAction(action_handler_t action_handler) override
     {
         _action_handler = action_handler;
+        _UpdateAcceptedFunctions();
 
         return *this;
     };
+#endif
 
     /// @brief Checks whether the external action function handler is set.
     /// @return 'true' if the external handler exists, `false` if not
     virtual bool HasExternalFunctionAction() override
     {
-        return _action_handler != nullptr;
+#if CAN_OBJECT_LEGACY_HANDLERS
+        if (_action_handler != nullptr)
+            return true;
+#endif
+        return _handler_table != nullptr && _handler_table->action != nullptr;
+    };
+
+    /// @brief Registers an external handler for the custom incoming function. Free IN function IDs only can be used
+    ///        (IDs below CAN_FUNC_FIRST_OUT_OK which are not used by the protocol).
+    ///        Registered handlers take precedence over the custom handlers of the handler table.
+    /// @param function_id Custom function ID.
+    /// @param custom_handler Pointer to the handler. nullptr removes the handler.
+    /// @return 'true' if the handler was registered, 'false' if the ID is reserved or all slots are used
+    virtual bool RegisterFunctionCustom(can_function_id_t function_id, custom_handler_t custom_handler) override
+    {
+        if (function_id >= CAN_INPUT_FUNCTIONS_COUNT || can_input_dispatch.handler_index[function_id] != CAN_INPUT_HANDLER_CUSTOM)
+            return false;
+
+        custom_function_t *free_slot = nullptr;
+        for (custom_function_t &custom : _custom_functions)
+        {
+            if (custom.handler != nullptr && custom.function_id == function_id)
+            {
+                free_slot = &custom;
+                break;
+            }
+            if (custom.handler == nullptr && free_slot == nullptr)
+                free_slot = &custom;
+        }
+        if (free_slot == nullptr)
+            return custom_handler == nullptr;
+
+        free_slot->function_id = function_id;
+        free_slot->handler = custom_handler;
+        _UpdateAcceptedFunctions();
+
+        return true;
+    };
+
+    /// @brief Checks whether the external handler of the custom function is set.
+    /// @param function_id Custom function ID.
+    /// @return 'true' if the external handler exists, `false` if not
+    virtual bool HasExternalFunctionCustom(can_function_id_t function_id) override
+    {
+        return _FindCustomHandler(function_id) != nullptr || _FindTableCustomHandler(function_id) != nullptr;
+    };
+
+    /// @brief Sets the table of context-aware handlers. The table isn't copied, it can be shared by many objects.
+    ///        Legacy handlers registered by RegisterFunctionXXX() take precedence over the handlers of the table.
+    ///        Silent listeners with real-time handlers wait for the first real-time frame.
+    /// @param handler_table Pointer to the table. nullptr removes the table.
+    /// @return CANObjectInterface reference
+    virtual CANObjectInterface &SetHandlerTable(const can_handler_table_t *handler_table) override
+    {
+        _handler_table = handler_table;
+        if (IsObjectTypeSilent() && HasExternalFunctionSetRealtime())
+            _realtime_stopped = true;
+        _UpdateAcceptedFunctions();
+
+        return *this;
+    };
+
+    /// @brief Returns the table of context-aware handlers.
+    /// @return Pointer to the table or nullptr if it isn't set
+    virtual const can_handler_table_t *GetHandlerTable() override
+    {
+        return _handler_table;
     };
 
     /// @brief Sets type of object.
@@ -655,15 +977,20 @@ public:
     virtual CANObjectInterface &SetObjectType(object_type_t object_type) override
     {
         _object_type = object_type;
+        _UpdateAcceptedFunctions();
 
         return *this;
     };
 
-    /// @brief Performs processing of CANObjects
+    /// @brief Performs processing of CANObjects.
+    ///        The object may be called several times per tick: every call returns the next due automatic function
+    ///        in the order of priority (real-time, event, error event, timer), until all of them are served
+    ///        or the limit of frames per tick is reached.
     /// @param time Current time
     /// @param can_frame [OUT] CAN frame for storing the outgoing data
     /// @param error [OUT] An outgoing error structure. It will be filled by object if something went wrong.
-    /// @return The result of CANObject processing (should we send any CAN frames or not)
+    /// @return The result of CANObject processing (should we send any CAN frames or not).
+    ///         CAN_RESULT_IGNORE means that there is nothing more to send in this tick.
     virtual can_result_t Process(uint32_t time, can_frame_t &can_frame, can_error_t &error) override
     {
         // Check data timeout for real-time silent (listener) objects
@@ -672,25 +999,36 @@ public:
             if (HasExternalFunctionSetRealtime() &&
                 !DoesRealtimeStopped() &&
                 _realtime_frame_interval > 0 &&
-                time - _last_realtime_frame_time >= (uint32_t)(_realtime_frame_interval * (_realtime_frames_can_lost + 1) + (_realtime_frame_interval >> 1))) // _realtime_frames_can_lost+1.5 interframe time interval
+                time - _last_realtime_frame_time >= (uint32_t)_GetRealtimeInterval() * (_realtime_frames_can_lost + 1) + (_GetRealtimeInterval() >> 1)) // _realtime_frames_can_lost+1.5 interframe time interval
             {
                 _realtime_has_error = true;
-                _set_realtime_error_handler(time - _last_realtime_frame_time);
+                _CallSetRealtimeErrorHandler(time - _last_realtime_frame_time);
                 _realtime_stopped = true;
             }
             return CAN_RESULT_IGNORE; // all other functions are ignored for silent objects
         }
 
-        timer_type_t max_timer_type = CAN_TIMER_TYPE_NONE;
-        event_type_t max_event_type = CAN_EVENT_TYPE_NONE;
-        for (uint8_t i = 0; i < _item_count; i++)
+        // new tick: all automatic functions can be served again
+        if (time != _process_time)
         {
-            if ((_states_of_data_fields[i] & CAN_TIMER_TYPE_MASK) > max_timer_type)
-                max_timer_type = (timer_type_t)(_states_of_data_fields[i] & (uint8_t)CAN_TIMER_TYPE_MASK);
+            _process_time = time;
+            _process_served_functions = CAN_AUTO_FUNC_NONE;
+            _process_frames_count = 0;
+        }
 
-            if ((_states_of_data_fields[i] & CAN_EVENT_TYPE_MASK) > max_event_type)
-                max_event_type = (event_type_t)(_states_of_data_fields[i] & (uint8_t)CAN_EVENT_TYPE_MASK);
+        // processing started late (the first deadline is missed by the whole period):
+        // the first timer frame goes at the next point of the phase grid, so timers of different objects aren't fired together
+        if (!_timer_started && _timer_period != CAN_TIMER_DISABLED && _timer_period > 0 &&
+            (int32_t)(time - _next_timer_time) >= (int32_t)_timer_period)
+        {
+            uint32_t grid_time = _GetTimerGridTime(time);
+            _next_timer_time = (grid_time == time) ? grid_time : grid_time + _timer_period;
         }
+
+        timer_type_t max_timer_type = CAN_TIMER_TYPE_NONE;
+        event_type_t max_event_type = CAN_EVENT_TYPE_NONE;
+        bool has_normal_event = false;
+        _GetDataFieldsStates(max_timer_type, max_event_type, has_normal_event);
         if (max_event_type > CAN_EVENT_TYPE_NONE &&
             max_event_type != CAN_EVENT_TYPE_ERROR &&
             _error_code_hardware > 0)
@@ -699,77 +1037,191 @@ public:
             _error_code_hardware = 0;
         }
 
-        can_result_t handler_result = CAN_RESULT_IGNORE;
-
-        clear_can_frame_struct(can_frame);
+        uint8_t due_functions = CAN_AUTO_FUNC_NONE;
         if (_realtime_frame_interval > 0 &&
             !DoesRealtimeStopped() &&
-            time - _last_realtime_frame_time >= _realtime_frame_interval)
+            time - _last_realtime_frame_time >= _GetRealtimeDueInterval())
         {
-            // Automatic sending of real-time data by sender object
-            handler_result = _PrepareRealtimeCanFrame(can_frame, error);
-            if (handler_result == CAN_RESULT_CAN_FRAME)
-            {
-                _last_realtime_frame_time = time;
-                if (_realtime_zero_point == GetValue(0))
-                {
-                    _realtime_stopped = true;
-                }
-            }
+            due_functions |= CAN_AUTO_FUNC_REALTIME;
         }
-        else if (max_event_type == CAN_EVENT_TYPE_NORMAL)
+        if (has_normal_event)
         {
             // CAN_EVENT_TYPE_NORMAL should be sent immediately, we don't need to check the time
-            if (HasExternalFunctionEvent())
-            {
-                handler_result = _event_handler(can_frame, max_event_type, error);
-            }
-            else
-            {
-                handler_result = _PrepareEventCanFrame(max_event_type, can_frame, error);
-            }
+            due_functions |= CAN_AUTO_FUNC_EVENT;
+        }
+        if (max_event_type > CAN_EVENT_TYPE_NORMAL &&
+            _error_period != CAN_ERROR_DISABLED &&
+            time - _last_event_time >= _error_period) // error flood prevention
+        {
+            due_functions |= CAN_AUTO_FUNC_ERROR_EVENT;
+        }
+        if (max_timer_type != CAN_TIMER_TYPE_NONE &&
+            _timer_period != CAN_TIMER_DISABLED &&
+            (int32_t)(time - _next_timer_time) >= 0 &&
+            (DoesTimerHaveNewData() || IsTimerInFloodMode()))
+        {
+            due_functions |= CAN_AUTO_FUNC_TIMER;
+        }
+        due_functions &= ~_process_served_functions;
+
+        can_result_t handler_result = CAN_RESULT_IGNORE;
+
+        // bits of can_auto_function_t are ordered by priority: the lowest bit is the most important one
+        for (uint8_t func = CAN_AUTO_FUNC_FIRST; due_functions != CAN_AUTO_FUNC_NONE; func <<= 1)
+        {
+            if ((due_functions & func) == 0)
+                continue;
 
-            // we need to flush the NORMAL event state of all data fields
-            for (uint8_t i = 0; i < _item_count; i++)
+            if (_process_frames_count >= _max_frames_per_tick)
             {
-                if ((_states_of_data_fields[i] & CAN_EVENT_TYPE_MASK) == CAN_EVENT_TYPE_NORMAL)
-                    _states_of_data_fields[i] = (_states_of_data_fields[i] & (uint8_t)CAN_TIMER_TYPE_MASK) | CAN_EVENT_TYPE_NONE;
+                // all remaining due functions are postponed to the next tick
+                for (; due_functions != CAN_AUTO_FUNC_NONE; due_functions &= due_functions - 1)
+                    _deferred_frames_count++;
+
+                return CAN_RESULT_IGNORE;
             }
-        }
-        else if (max_event_type > CAN_EVENT_TYPE_NORMAL && _error_period != CAN_ERROR_DISABLED)
-        {
-            // error flood prevention
-            if (time - _last_event_time >= _error_period)
+
+            due_functions &= ~func;
+            _process_served_functions |= func;
+
+            can_tx_class_t tx_class = _GetAutoFunctionTxClass((can_auto_function_t)func);
+            if (_tx_budget != nullptr && !_tx_budget->HasToken(tx_class, time))
             {
-                if (HasExternalFunctionEvent())
+                // deferred function stays due until the next tick; dropped one is consumed without the frame
+                if (_tx_budget->GetPolicy() == CAN_TX_BUDGET_POLICY_DROP)
                 {
-                    handler_result = _event_handler(can_frame, max_event_type, error);
+                    _tx_budget->CountDropped(tx_class);
+                    _SkipAutoFunction((can_auto_function_t)func, time);
                 }
                 else
                 {
-                    handler_result = _PrepareEventCanFrame(max_event_type, can_frame, error);
+                    _tx_budget->CountDeferred(tx_class);
                 }
-                _last_event_time = time;
+                continue;
+            }
+
+            clear_can_frame_struct(can_frame);
+            uint32_t start_cycles = (_profiler != nullptr) ? _profiler->GetCycles() : 0;
+            handler_result = _ProcessAutoFunction((can_auto_function_t)func, time, can_frame, error,
+                                                  max_timer_type, max_event_type);
+            if (_profiler != nullptr)
+                _profiler->RecordSlot(GetId(), can_profile_slot_of((can_auto_function_t)func), start_cycles);
+            if (handler_result != CAN_RESULT_IGNORE)
+            {
+                if (_tx_budget != nullptr)
+                    _tx_budget->TakeToken(tx_class, time);
+
+                _process_frames_count++;
+                return handler_result;
             }
         }
-        else if (max_timer_type != CAN_TIMER_TYPE_NONE && _timer_period != CAN_TIMER_DISABLED && time - _last_timer_time >= _timer_period)
+
+        return CAN_RESULT_IGNORE;
+    };
+
+    /// @brief Returns the time when the earliest automatic function of the object is (or was) due.
+    ///        A NORMAL event is due since the first call which sees it pending, so the delay of events postponed
+    ///        by frame limits is kept.
+    /// @param time Current time
+    /// @param deadline [OUT] The time of the earliest due automatic function. It can be in the past if the function is overdue.
+    /// @return 'true' if the object has any active automatic function, 'false' if not.
+    virtual bool GetNextDeadline(uint32_t time, uint32_t &deadline) override
+    {
+        if (IsObjectTypeSilent())
+            return false;
+
+        timer_type_t max_timer_type = CAN_TIMER_TYPE_NONE;
+        event_type_t max_event_type = CAN_EVENT_TYPE_NONE;
+        bool has_normal_event = false;
+        _GetDataFieldsStates(max_timer_type, max_event_type, has_normal_event);
+
+        bool has_deadline = false;
+        if (_realtime_frame_interval > 0 && !DoesRealtimeStopped())
+            _UpdateDeadline(time, _last_realtime_frame_time + _GetRealtimeDueInterval(), deadline, has_deadline);
+
+        // SetValue() has no clock: the pending time of the event is taken by the first tick which sees it
+        if (!has_normal_event)
+        {
+            _normal_event_time_set = false;
+        }
+        else
         {
-            if (DoesTimerHaveNewData() || IsTimerInFloodMode())
+            if (!_normal_event_time_set)
             {
-                if (HasExternalFunctionTimer())
-                {
-                    handler_result = _timer_handler(can_frame, max_timer_type, error);
-                }
-                else
-                {
-                    handler_result = _PrepareTimerCanFrame(max_timer_type, can_frame, error);
-                }
-                _last_timer_time = time;
-                _has_new_data = false;
+                _normal_event_time = time;
+                _normal_event_time_set = true;
             }
+            _UpdateDeadline(time, _normal_event_time, deadline, has_deadline);
         }
 
-        return handler_result;
+        if (max_event_type > CAN_EVENT_TYPE_NORMAL && _error_period != CAN_ERROR_DISABLED)
+            _UpdateDeadline(time, _last_event_time + _error_period, deadline, has_deadline);
+
+        if (max_timer_type != CAN_TIMER_TYPE_NONE && _timer_period != CAN_TIMER_DISABLED &&
+            (DoesTimerHaveNewData() || IsTimerInFloodMode()))
+            _UpdateDeadline(time, _next_timer_time, deadline, has_deadline);
+
+        return has_deadline;
+    };
+
+    /// @brief Sets the maximum number of frames which can be produced by Process() during one tick.
+    ///        Due automatic functions above the limit are postponed to the next tick and counted as deferred.
+    /// @param max_frames The number of frames, at least 1.
+    /// @return CANObjectInterface reference
+    virtual CANObjectInterface &SetMaxFramesPerTick(uint8_t max_frames) override
+    {
+        _max_frames_per_tick = (max_frames > 0) ? max_frames : 1;
+
+        return *this;
+    };
+
+    /// @brief Returns the maximum number of frames which can be produced by Process() during one tick.
+    /// @return The number of frames.
+    virtual uint8_t GetMaxFramesPerTick() override
+    {
+        return _max_frames_per_tick;
+    };
+
+    /// @brief Returns the number of automatic frames which were postponed because of the frames per tick limit.
+    /// @return The number of deferred frames since the object creation.
+    virtual uint32_t GetDeferredFramesCount() override
+    {
+        return _deferred_frames_count;
+    };
+
+    /// @brief Attaches the TX budget to the object. Automatic functions over the budget are deferred or dropped
+    ///        according to the budget policy, answers to incoming frames are limited by CANManager.
+    /// @param tx_budget Pointer to the budget. nullptr removes the limits.
+    /// @return CANObjectInterface reference
+    virtual CANObjectInterface &SetTxBudget(CANTxBudget *tx_budget) override
+    {
+        _tx_budget = tx_budget;
+
+        return *this;
+    };
+
+    /// @brief Returns the TX budget of the object
+    /// @return Pointer to the budget or nullptr if the object isn't limited
+    virtual CANTxBudget *GetTxBudget() override
+    {
+        return _tx_budget;
+    };
+
+    /// @brief Attaches the profiler which measures execution time of handlers and automatic functions of the object.
+    /// @param profiler Pointer to the profiler. nullptr disables profiling.
+    /// @return CANObjectInterface reference
+    virtual CANObjectInterface &SetProfiler(CANProfilerInterface *profiler) override
+    {
+        _profiler = profiler;
+
+        return *this;
+    };
+
+    /// @brief Returns the profiler of the object
+    /// @return Pointer to the profiler or nullptr if the object isn't profiled
+    virtual CANProfilerInterface *GetProfiler() override
+    {
+        return _profiler;
     };
 
     /// @brief Process incoming CAN frame
@@ -796,173 +1248,88 @@ public:
             return CAN_RESULT_ERROR;
         }
 
-        can_result_t handler_result = CAN_RESULT_ERROR;
+        // direct-indexed dispatch: IN functions only, all others are unsupported
+        uint8_t handler_index = (can_frame.function_id < CAN_INPUT_FUNCTIONS_COUNT)
+                                    ? can_input_dispatch.handler_index[can_frame.function_id]
+                                    : (uint8_t)CAN_INPUT_HANDLER_UNSUPPORTED;
+        uint32_t start_cycles = (_profiler != nullptr) ? _profiler->GetCycles() : 0;
+        can_result_t handler_result = (this->*_input_handlers[handler_index])(can_frame, error);
+        if (_profiler != nullptr)
+            _profiler->RecordSlot(GetId(), (can_profile_slot_t)handler_index, start_cycles);
 
-        switch (can_frame.function_id)
+        // restoring ID in case an external handler has overwritten it
+        can_frame.object_id = GetId();
+
+        if (!can_frame.initialized && error.error_section == ERROR_SECTION_NONE && handler_result != CAN_RESULT_IGNORE)
         {
-        case CAN_FUNC_SET_IN:
-            if (HasExternalFunctionSet())
-            {
-                handler_result = _set_handler(can_frame, error);
-            }
-            else
-            {
-                handler_result = CAN_RESULT_ERROR;
-                can_frame.initialized = false;
-                error.error_section = ERROR_SECTION_CAN_OBJECT;
-                error.error_code = ERROR_CODE_OBJECT_SET_FUNCTION_IS_MISSING;
+            handler_result = CAN_RESULT_ERROR;
+            error.error_section = ERROR_SECTION_CAN_OBJECT;
+            error.error_code = ERROR_CODE_OBJECT_INCORRECT_FUNCTION_WORKFLOW;
+            if (error.function_id == CAN_FUNC_NONE)
                 error.function_id = CAN_FUNC_EVENT_ERROR;
-            }
+        }
+
+        return handler_result;
+    };
+
+    /// @brief Checks incoming frame before CANManager stores it in the buffer (IncomingCANFrame() may be called from ISR).
+    ///        The check uses precomputed bitmap of accepted functions and length rules and doesn't change the object.
+    ///        The result and the error are the same as InputCanFrame() would return without calling the handlers.
+    /// @param data Frame data including function ID
+    /// @param length Frame data length including function ID
+    /// @param check_lock 'false' if the lock level may change before the frame is processed (LOCK frames are in the buffer)
+    /// @param error [OUT] Error answer required by the protocol for the rejected frame
+    /// @return CAN_RESULT_CAN_FRAME if the frame should be stored, CAN_RESULT_ERROR if the frame should be answered with the error,
+    ///         CAN_RESULT_IGNORE if the frame should be dropped silently
+    virtual can_result_t ValidateIncomingFrame(const uint8_t *data, uint8_t length, bool check_lock, can_error_t &error) override
+    {
+        can_function_id_t function_id = (can_function_id_t)data[0];
+
+        // the answers to lockable functions depend on the lock level, which may be changed by the buffered LOCK frame
+        if (!check_lock && function_id != CAN_FUNC_LOCK_IN && function_id != CAN_FUNC_SYSTEM_REQUEST_IN)
+            return CAN_RESULT_CAN_FRAME;
+
+        if (function_id < _validated_functions_count &&
+            (_accepted_functions[function_id >> 5] & ((uint32_t)1 << (function_id & 0x1F))) != 0)
+            return _ValidateIncomingFrameLength(function_id, data, length, error);
+
+        // the same order of checks as in InputCanFrame(): the lock goes first
+        if (_IsLockedForFunction(function_id))
+        {
+            error.error_section = ERROR_SECTION_CAN_OBJECT;
+            error.error_code = ERROR_CODE_OBJECT_LOCKED;
+            error.function_id = CAN_FUNC_EVENT_ERROR;
+            return CAN_RESULT_ERROR;
+        }
+
+        error.error_section = ERROR_SECTION_CAN_OBJECT;
+        error.function_id = CAN_FUNC_EVENT_ERROR;
+        switch (function_id)
+        {
+        case CAN_FUNC_SET_IN:
+            error.error_code = ERROR_CODE_OBJECT_SET_FUNCTION_IS_MISSING;
             break;
 
         case CAN_FUNC_TOGGLE_IN:
-            if (HasExternalFunctionToggle())
-            {
-                if (can_frame.raw_data_length == 1)
-                {
-                    handler_result = _toggle_handler(can_frame, error);
-                }
-                else
-                {
-                    handler_result = CAN_RESULT_ERROR;
-                    can_frame.initialized = false;
-                    error.error_section = ERROR_SECTION_CAN_OBJECT;
-                    error.error_code = ERROR_CODE_OBJECT_TOGGLE_COMMAND_FRAME_SHOULD_NOT_HAVE_DATA;
-                    error.function_id = CAN_FUNC_EVENT_ERROR;
-                }
-            }
-            else
-            {
-                handler_result = CAN_RESULT_ERROR;
-                can_frame.initialized = false;
-                error.error_section = ERROR_SECTION_CAN_OBJECT;
-                error.error_code = ERROR_CODE_OBJECT_TOGGLE_FUNCTION_IS_MISSING;
-                error.function_id = CAN_FUNC_EVENT_ERROR;
-            }
+            error.error_code = ERROR_CODE_OBJECT_TOGGLE_FUNCTION_IS_MISSING;
             break;
 
         case CAN_FUNC_ACTION_IN:
-            if (HasExternalFunctionAction())
-            {
-                if (can_frame.raw_data_length == 1)
-                {
-                    handler_result = _action_handler(can_frame, error);
-                }
-                else
-                {
-                    handler_result = CAN_RESULT_ERROR;
-                    can_frame.initialized = false;
-                    error.error_section = ERROR_SECTION_CAN_OBJECT;
-                    error.error_code = ERROR_CODE_OBJECT_ACTION_COMMAND_FRAME_SHOULD_NOT_HAVE_DATA;
-                    error.function_id = CAN_FUNC_EVENT_ERROR;
-                }
-            }
-            else
-            {
-                handler_result = CAN_RESULT_ERROR;
-                can_frame.initialized = false;
-                error.error_section = ERROR_SECTION_CAN_OBJECT;
-                error.error_code = ERROR_CODE_OBJECT_ACTION_FUNCTION_IS_MISSING;
-                error.function_id = CAN_FUNC_EVENT_ERROR;
-            }
+            error.error_code = ERROR_CODE_OBJECT_ACTION_FUNCTION_IS_MISSING;
             break;
 
         case CAN_FUNC_SET_REAL_TIME_IN:
-            // By default sender objects shouldn't react to this type of frames, so default result is CAN_RESULT_IGNORE
-            handler_result = CAN_RESULT_IGNORE;
-            if (IsObjectTypeSilent() && HasExternalFunctionSetRealtime() && !HasRealtimeError())
-            {
-                if (can_frame.raw_data_length > 2 && _IsCorrectNextRealtimeFrameId(can_frame.data[0]))
-                {
-                    _last_realtime_frame_time = can_frame.time_ms;
-                    _realtime_silent_should_ignore_frame_id_once = false;
-                    _realtime_frame_id = can_frame.data[0];
-                    T data = *(T *)&can_frame.data[1];
-                    SetValue(0, data);
-                    handler_result = _set_realtime_handler(can_frame, error);
-                    if (data == *(T *)GetRealtimeZeroPoint())
-                    {
-                        _realtime_stopped = true;
-                    }
-                }
-            }
+            // sender objects ignore real-time frames
+            clear_can_error_struct(error);
+            return CAN_RESULT_IGNORE;
+
+        default:
+            error.error_code = ERROR_CODE_OBJECT_UNSUPPORTED_FUNCTION;
             break;
+        }
 
-        case CAN_FUNC_LOCK_IN:
-            if (can_frame.raw_data_length != 2)
-            {
-                handler_result = CAN_RESULT_ERROR;
-                can_frame.initialized = false;
-                error.error_section = ERROR_SECTION_CAN_OBJECT;
-                error.error_code = ERROR_CODE_OBJECT_LOCK_COMMAND_FRAME_DATA_LENGTH_ERROR;
-                error.function_id = CAN_FUNC_LOCK_OUT_ERR;
-            }
-            else if (!_IsItKnownLockLevel((lock_func_level_t)can_frame.data[0]))
-            {
-                handler_result = CAN_RESULT_ERROR;
-                can_frame.initialized = false;
-                error.error_section = ERROR_SECTION_CAN_OBJECT;
-                error.error_code = ERROR_CODE_OBJECT_LOCK_LEVEL_IS_UNKNOWN;
-                error.function_id = CAN_FUNC_LOCK_OUT_ERR;
-            }
-            else
-            {
-                // save lock level because can frame may be rewrited by handler
-                lock_func_level_t specified_lock_level = (lock_func_level_t)can_frame.data[0];
-                if (HasExternalFunctionLock())
-                {
-                    handler_result = _lock_handler(can_frame, error);
-                }
-                else
-                {
-                    handler_result = _PrepareRawCanFrame(can_frame, error, CAN_FUNC_LOCK_OUT_OK, &specified_lock_level, 1);
-                }
-
-                // if handler was successful then we need to save specified lock level
-                if (handler_result == CAN_RESULT_CAN_FRAME)
-                {
-                    _lock_level = specified_lock_level;
-                }
-            }
-            break;
-
-        case CAN_FUNC_REQUEST_IN:
-            if (HasExternalFunctionRequest())
-            {
-                handler_result = _request_handler(can_frame, error);
-            }
-            else
-            {
-                handler_result = _PrepareRequestCanFrame(can_frame, error);
-            }
-            break;
-
-        case CAN_FUNC_SYSTEM_REQUEST_IN:
-            handler_result = _PrepareSystemRequestCanFrame(can_frame, error);
-            break;
-
-        default:
-            handler_result = CAN_RESULT_ERROR;
-            can_frame.initialized = false;
-            error.error_section = ERROR_SECTION_CAN_OBJECT;
-            error.error_code = ERROR_CODE_OBJECT_UNSUPPORTED_FUNCTION;
-            error.function_id = CAN_FUNC_EVENT_ERROR;
-            break;
-        }
-        // restoring ID in case an external handler has overwritten it
-        can_frame.object_id = GetId();
-
-        if (!can_frame.initialized && error.error_section == ERROR_SECTION_NONE && handler_result != CAN_RESULT_IGNORE)
-        {
-            handler_result = CAN_RESULT_ERROR;
-            error.error_section = ERROR_SECTION_CAN_OBJECT;
-            error.error_code = ERROR_CODE_OBJECT_INCORRECT_FUNCTION_WORKFLOW;
-            if (error.function_id == CAN_FUNC_NONE)
-                error.function_id = CAN_FUNC_EVENT_ERROR;
-        }
-
-        return handler_result;
-    };
+        return CAN_RESULT_ERROR;
+    };
 
     /// @brief Fills CAN frame from the object with specified data
     /// @param can_frame [OUT] CAN frame for filling
@@ -997,6 +1364,13 @@ public:
         return _timer_period;
     };
 
+    /// @brief Returns the phase offset of the timer.
+    /// @return Timer's phase offset in milliseconds.
+    virtual uint16_t GetTimerPhase() override
+    {
+        return _timer_phase;
+    };
+
     /// @brief Return the timer's mode.
     /// @return 'true' if timer works in flood mode, 'false' if timer works in frame limit mode.
     virtual bool IsTimerInFloodMode() override
@@ -1025,7 +1399,8 @@ public:
         return (GetObjectType() == CAN_OBJECT_TYPE_SYSTEM_BLOCK_INFO) ||
                (GetObjectType() == CAN_OBJECT_TYPE_SYSTEM_BLOCK_HEALTH) ||
                (GetObjectType() == CAN_OBJECT_TYPE_SYSTEM_BLOCK_FEATURES) ||
-               (GetObjectType() == CAN_OBJECT_TYPE_SYSTEM_BLOCK_ERROR);
+               (GetObjectType() == CAN_OBJECT_TYPE_SYSTEM_BLOCK_ERROR) ||
+               (GetObjectType() == CAN_OBJECT_TYPE_SYSTEM_BLOCK_STATS);
     };
 
     /// @brief Checks if the object is ordinary.
@@ -1108,7 +1483,11 @@ public:
             if (value != _realtime_zero_point && DoesRealtimeStopped())
             {
                 _realtime_stopped = false;
+                _realtime_current_interval = 0;
             }
+
+            if (_realtime_max_interval > 0 && index == 0 && !_realtime_change_pending)
+                _realtime_change_pending = _IsRealtimeSignificantChange(value);
         }
     };
 
@@ -1134,20 +1513,39 @@ public:
         return _data_fields[index];
     }
 
+protected:
+    /// @brief Returns the state of the data field (timer type | event type)
+    /// @param index Index of data field
+    /// @return The state of the data field. If the index is out of range, zero state will be returned.
+    uint8_t _GetDataFieldState(uint8_t index)
+    {
+        if (index >= _item_count)
+            return 0;
+
+        return _states_of_data_fields[index];
+    }
+
 private:
+    static constexpr uint8_t _realtime_interval_offset = 1 + sizeof(T); // data: frame ID, value, interval
+
     can_object_id_t _id = 0;
 
     // local data storage
     T _data_fields[_item_count] = {0};
     uint8_t _states_of_data_fields[_item_count] = {0};
 
-    uint32_t _last_timer_time = 0;
+    uint32_t _next_timer_time = 0; // due time of the next timer frame, compared as a signed difference
     uint32_t _last_event_time = 0;
+    uint32_t _normal_event_time = 0; // time since which the NORMAL event is pending
+    bool _normal_event_time_set = false;
     uint32_t _last_realtime_frame_time = 0;
     uint8_t _realtime_frame_id = 0;
     bool _realtime_silent_should_ignore_frame_id_once = false;
 
     uint16_t _timer_period = CAN_TIMER_DISABLED;
+    uint16_t _timer_phase = 0;
+    bool _timer_phase_is_auto = true;
+    bool _timer_started = false;
     uint16_t _error_period = CAN_ERROR_DISABLED;
     error_code_hardware_t _error_code_hardware = 0;
 
@@ -1155,9 +1553,25 @@ private:
     uint16_t _realtime_frame_interval = 0;
     bool _realtime_stopped = false;
 
+    // adaptive real-time sending: the interval grows from _realtime_frame_interval up to _realtime_max_interval
+    uint16_t _realtime_max_interval = 0;     // 0 if the adaptive mode is disabled
+    uint16_t _realtime_current_interval = 0; // interval to the next frame (sent or received); 0 means _realtime_frame_interval
+    bool _realtime_change_pending = false;   // the value changed by the threshold since the last frame
+    T _realtime_change_threshold = 0;
+    T _realtime_last_sent_value = 0;
+
     bool _flood_mode = false;
     bool _has_new_data = false;
 
+    // automatic functions state of the current tick
+    uint32_t _process_time = 0;
+    uint8_t _process_served_functions = CAN_AUTO_FUNC_NONE;
+    uint8_t _process_frames_count = 0;
+    uint8_t _max_frames_per_tick = CAN_MAX_FRAMES_PER_TICK_DEFAULT;
+    uint32_t _deferred_frames_count = 0;
+    CANTxBudget *_tx_budget = nullptr;
+    CANProfilerInterface *_profiler = nullptr;
+
     T _realtime_zero_point = 0;
     uint8_t _realtime_frames_can_lost = 0;
     bool _realtime_has_error = false;
@@ -1165,6 +1579,11 @@ private:
     object_type_t _object_type = CAN_OBJECT_TYPE_UNKNOWN;
     lock_func_level_t _lock_level = CAN_LOCK_LEVEL_UNLOCKED;
 
+    // bitmap of incoming functions 0x00..0x3F which have handlers and are allowed by the lock level
+    static constexpr uint8_t _validated_functions_count = 0x40;
+    volatile uint32_t _accepted_functions[2] = {0};
+
+#if CAN_OBJECT_LEGACY_HANDLERS
     event_handler_t _event_handler = nullptr;
     set_handler_t _set_handler = nullptr;
     set_realtime_handler_t _set_realtime_handler = nullptr;
@@ -1174,6 +1593,449 @@ private:
     request_handler_t _request_handler = nullptr;
     toggle_handler_t _toggle_handler = nullptr;
     action_handler_t _action_handler = nullptr;
+#endif
+
+    // shared table of context-aware handlers
+    const can_handler_table_t *_handler_table = nullptr;
+
+    // handlers of custom incoming functions
+    struct custom_function_t
+    {
+        can_function_id_t function_id = CAN_FUNC_NONE;
+        custom_handler_t handler = nullptr;
+    };
+    custom_function_t _custom_functions[CAN_OBJECT_MAX_CUSTOM_FUNCTIONS > 0 ? CAN_OBJECT_MAX_CUSTOM_FUNCTIONS : 1] = {};
+
+    // handlers of incoming functions in the order of can_input_handler_t; the table is shared by all objects of the class
+    using input_handler_t = can_result_t (CANObject::*)(can_frame_t &can_frame, can_error_t &error);
+    static constexpr input_handler_t _input_handlers[CAN_INPUT_HANDLER_COUNT] = {
+        &CANObject::_InputUnsupported,
+        &CANObject::_InputCustom,
+        &CANObject::_InputSet,
+        &CANObject::_InputToggle,
+        &CANObject::_InputAction,
+        &CANObject::_InputSetRealtime,
+        &CANObject::_InputLock,
+        &CANObject::_InputRequest,
+        &CANObject::_InputSystemRequest,
+    };
+
+    /// @brief Handles CAN_FUNC_SET_IN
+    /// @param can_frame Incoming and outgoing CAN frame.
+    /// @param error An outgoing error structure. It will be filled by object if something went wrong.
+    /// @return The result of incoming can frame processing (should we send any CAN frames or not)
+    can_result_t _InputSet(can_frame_t &can_frame, can_error_t &error)
+    {
+        if (HasExternalFunctionSet())
+            return _CallFunctionHandler(CAN_INPUT_HANDLER_SET, can_frame, error);
+
+        return _InputError(can_frame, error, ERROR_CODE_OBJECT_SET_FUNCTION_IS_MISSING);
+    }
+
+    /// @brief Handles CAN_FUNC_TOGGLE_IN
+    /// @param can_frame Incoming and outgoing CAN frame.
+    /// @param error An outgoing error structure. It will be filled by object if something went wrong.
+    /// @return The result of incoming can frame processing (should we send any CAN frames or not)
+    can_result_t _InputToggle(can_frame_t &can_frame, can_error_t &error)
+    {
+        if (!HasExternalFunctionToggle())
+            return _InputError(can_frame, error, ERROR_CODE_OBJECT_TOGGLE_FUNCTION_IS_MISSING);
+
+        if (can_frame.raw_data_length != 1)
+            return _InputError(can_frame, error, ERROR_CODE_OBJECT_TOGGLE_COMMAND_FRAME_SHOULD_NOT_HAVE_DATA);
+
+        return _CallFunctionHandler(CAN_INPUT_HANDLER_TOGGLE, can_frame, error);
+    }
+
+    /// @brief Handles CAN_FUNC_ACTION_IN
+    /// @param can_frame Incoming and outgoing CAN frame.
+    /// @param error An outgoing error structure. It will be filled by object if something went wrong.
+    /// @return The result of incoming can frame processing (should we send any CAN frames or not)
+    can_result_t _InputAction(can_frame_t &can_frame, can_error_t &error)
+    {
+        if (!HasExternalFunctionAction())
+            return _InputError(can_frame, error, ERROR_CODE_OBJECT_ACTION_FUNCTION_IS_MISSING);
+
+        if (can_frame.raw_data_length != 1)
+            return _InputError(can_frame, error, ERROR_CODE_OBJECT_ACTION_COMMAND_FRAME_SHOULD_NOT_HAVE_DATA);
+
+        return _CallFunctionHandler(CAN_INPUT_HANDLER_ACTION, can_frame, error);
+    }
+
+    /// @brief Handles CAN_FUNC_SET_REAL_TIME_IN
+    /// @param can_frame Incoming and outgoing CAN frame.
+    /// @param error An outgoing error structure. It will be filled by object if something went wrong.
+    /// @return The result of incoming can frame processing (should we send any CAN frames or not)
+    can_result_t _InputSetRealtime(can_frame_t &can_frame, can_error_t &error)
+    {
+        // By default sender objects shouldn't react to this type of frames, so default result is CAN_RESULT_IGNORE
+        if (!IsObjectTypeSilent() || !HasExternalFunctionSetRealtime() || HasRealtimeError())
+            return CAN_RESULT_IGNORE;
+
+        if (can_frame.raw_data_length <= 2 || !_IsCorrectNextRealtimeFrameId(can_frame.data[0]))
+            return CAN_RESULT_IGNORE;
+
+        _last_realtime_frame_time = can_frame.time_ms;
+        _realtime_silent_should_ignore_frame_id_once = false;
+        _realtime_frame_id = can_frame.data[0];
+        T data = can_wire_read<T>(&can_frame.data[1]);
+        SetValue(0, data);
+        // the adaptive sender adds the interval to the next frame
+        if (can_frame.raw_data_length >= sizeof(can_frame.function_id) + _realtime_interval_offset + sizeof(uint16_t))
+            _realtime_current_interval = can_wire_read<uint16_t>(&can_frame.data[_realtime_interval_offset]);
+        else
+            _realtime_current_interval = 0;
+        can_result_t handler_result = _CallFunctionHandler(CAN_INPUT_HANDLER_SET_REAL_TIME, can_frame, error);
+        if (data == *(T *)GetRealtimeZeroPoint())
+        {
+            _realtime_stopped = true;
+        }
+
+        return handler_result;
+    }
+
+    /// @brief Handles CAN_FUNC_LOCK_IN
+    /// @param can_frame Incoming and outgoing CAN frame.
+    /// @param error An outgoing error structure. It will be filled by object if something went wrong.
+    /// @return The result of incoming can frame processing (should we send any CAN frames or not)
+    can_result_t _InputLock(can_frame_t &can_frame, can_error_t &error)
+    {
+        if (can_frame.raw_data_length != 2)
+            return _InputError(can_frame, error, ERROR_CODE_OBJECT_LOCK_COMMAND_FRAME_DATA_LENGTH_ERROR, CAN_FUNC_LOCK_OUT_ERR);
+
+        if (!_IsItKnownLockLevel((lock_func_level_t)can_frame.data[0]))
+            return _InputError(can_frame, error, ERROR_CODE_OBJECT_LOCK_LEVEL_IS_UNKNOWN, CAN_FUNC_LOCK_OUT_ERR);
+
+        // save lock level because can frame may be rewrited by handler
+        lock_func_level_t specified_lock_level = (lock_func_level_t)can_frame.data[0];
+        can_result_t handler_result = CAN_RESULT_ERROR;
+        if (HasExternalFunctionLock())
+        {
+            handler_result = _CallFunctionHandler(CAN_INPUT_HANDLER_LOCK, can_frame, error);
+        }
+        else
+        {
+            handler_result = _PrepareRawCanFrame(can_frame, error, CAN_FUNC_LOCK_OUT_OK, &specified_lock_level, 1);
+        }
+
+        // if handler was successful then we need to save specified lock level
+        if (handler_result == CAN_RESULT_CAN_FRAME)
+        {
+            _lock_level = specified_lock_level;
+            _UpdateAcceptedFunctions();
+        }
+
+        return handler_result;
+    }
+
+    /// @brief Handles CAN_FUNC_REQUEST_IN
+    /// @param can_frame Incoming and outgoing CAN frame.
+    /// @param error An outgoing error structure. It will be filled by object if something went wrong.
+    /// @return The result of incoming can frame processing (should we send any CAN frames or not)
+    can_result_t _InputRequest(can_frame_t &can_frame, can_error_t &error)
+    {
+        if (HasExternalFunctionRequest())
+            return _CallFunctionHandler(CAN_INPUT_HANDLER_REQUEST, can_frame, error);
+
+        return _PrepareRequestCanFrame(can_frame, error);
+    }
+
+    /// @brief Handles CAN_FUNC_SYSTEM_REQUEST_IN
+    /// @param can_frame Incoming and outgoing CAN frame.
+    /// @param error An outgoing error structure. It will be filled by object if something went wrong.
+    /// @return The result of incoming can frame processing (should we send any CAN frames or not)
+    can_result_t _InputSystemRequest(can_frame_t &can_frame, can_error_t &error)
+    {
+        return _PrepareSystemRequestCanFrame(can_frame, error);
+    }
+
+    /// @brief Handles free IN function IDs: calls the registered custom handler
+    /// @param can_frame Incoming and outgoing CAN frame.
+    /// @param error An outgoing error structure. It will be filled by object if something went wrong.
+    /// @return The result of incoming can frame processing (should we send any CAN frames or not)
+    can_result_t _InputCustom(can_frame_t &can_frame, can_error_t &error)
+    {
+        custom_handler_t custom_handler = _FindCustomHandler(can_frame.function_id);
+        if (custom_handler != nullptr)
+            return custom_handler(can_frame, error);
+
+        object_function_handler_t table_handler = _FindTableCustomHandler(can_frame.function_id);
+        if (table_handler != nullptr)
+            return table_handler(*this, can_frame, error, _handler_table->context);
+
+        return _InputUnsupported(can_frame, error);
+    }
+
+    /// @brief Handles unsupported functions
+    /// @param can_frame Incoming and outgoing CAN frame.
+    /// @param error An outgoing error structure. It will be filled by object if something went wrong.
+    /// @return The result of incoming can frame processing (should we send any CAN frames or not)
+    can_result_t _InputUnsupported(can_frame_t &can_frame, can_error_t &error)
+    {
+        return _InputError(can_frame, error, ERROR_CODE_OBJECT_UNSUPPORTED_FUNCTION);
+    }
+
+    /// @brief Calls the external handler of the incoming function: the legacy one or the one from the handler table.
+    ///        The handler must exist.
+    /// @param handler_index Handler of the function (SET, TOGGLE, ACTION, SET_REAL_TIME, LOCK or REQUEST)
+    /// @param can_frame Incoming and outgoing CAN frame.
+    /// @param error An outgoing error structure. It will be filled by object if something went wrong.
+    /// @return The result of the handler
+    can_result_t _CallFunctionHandler(can_input_handler_t handler_index, can_frame_t &can_frame, can_error_t &error)
+    {
+#if CAN_OBJECT_LEGACY_HANDLERS
+        set_handler_t legacy_handler = nullptr;
+        switch (handler_index)
+        {
+        case CAN_INPUT_HANDLER_SET:
+            legacy_handler = _set_handler;
+            break;
+        case CAN_INPUT_HANDLER_TOGGLE:
+            legacy_handler = _toggle_handler;
+            break;
+        case CAN_INPUT_HANDLER_ACTION:
+            legacy_handler = _action_handler;
+            break;
+        case CAN_INPUT_HANDLER_SET_REAL_TIME:
+            legacy_handler = _set_realtime_error_handler != nullptr ? _set_realtime_handler : nullptr;
+            break;
+        case CAN_INPUT_HANDLER_LOCK:
+            legacy_handler = _lock_handler;
+            break;
+        case CAN_INPUT_HANDLER_REQUEST:
+            legacy_handler = _request_handler;
+            break;
+        default:
+            break;
+        }
+        if (legacy_handler != nullptr)
+            return legacy_handler(can_frame, error);
+#endif
+
+        object_function_handler_t handler = nullptr;
+        switch (handler_index)
+        {
+        case CAN_INPUT_HANDLER_SET:
+            handler = _handler_table->set;
+            break;
+        case CAN_INPUT_HANDLER_TOGGLE:
+            handler = _handler_table->toggle;
+            break;
+        case CAN_INPUT_HANDLER_ACTION:
+            handler = _handler_table->action;
+            break;
+        case CAN_INPUT_HANDLER_SET_REAL_TIME:
+            handler = _handler_table->set_realtime;
+            break;
+        case CAN_INPUT_HANDLER_LOCK:
+            handler = _handler_table->lock;
+            break;
+        case CAN_INPUT_HANDLER_REQUEST:
+            handler = _handler_table->request;
+            break;
+        default:
+            break;
+        }
+        return handler(*this, can_frame, error, _handler_table->context);
+    }
+
+    /// @brief Calls the external event handler: the legacy one or the one from the handler table. The handler must exist.
+    /// @param can_frame CAN frame for filling with data.
+    /// @param event_type The type of the event
+    /// @param error An outgoing error structure. It will be filled by object if something went wrong.
+    /// @return The result of the handler
+    can_result_t _CallEventHandler(can_frame_t &can_frame, event_type_t event_type, can_error_t &error)
+    {
+#if CAN_OBJECT_LEGACY_HANDLERS
+        if (_event_handler != nullptr)
+            return _event_handler(can_frame, event_type, error);
+#endif
+        return _handler_table->event(*this, can_frame, event_type, error, _handler_table->context);
+    }
+
+    /// @brief Calls the external timer handler: the legacy one or the one from the handler table. The handler must exist.
+    /// @param can_frame CAN frame for filling with data.
+    /// @param timer_type The type of the timer
+    /// @param error An outgoing error structure. It will be filled by object if something went wrong.
+    /// @return The result of the handler
+    can_result_t _CallTimerHandler(can_frame_t &can_frame, timer_type_t timer_type, can_error_t &error)
+    {
+#if CAN_OBJECT_LEGACY_HANDLERS
+        if (_timer_handler != nullptr)
+            return _timer_handler(can_frame, timer_type, error);
+#endif
+        return _handler_table->timer(*this, can_frame, timer_type, error, _handler_table->context);
+    }
+
+    /// @brief Calls the external real-time error handler: the legacy one or the one from the handler table.
+    ///        The handler must exist.
+    /// @param time_has_passed_ms Time since the last real-time frame
+    void _CallSetRealtimeErrorHandler(uint32_t time_has_passed_ms)
+    {
+#if CAN_OBJECT_LEGACY_HANDLERS
+        if (_set_realtime_handler != nullptr && _set_realtime_error_handler != nullptr)
+        {
+            _set_realtime_error_handler(time_has_passed_ms);
+            return;
+        }
+#endif
+        _handler_table->set_realtime_error(*this, time_has_passed_ms, _handler_table->context);
+    }
+
+    /// @brief Fills the error answer to the incoming frame
+    /// @param can_frame Incoming CAN frame. It becomes uninitialized.
+    /// @param error [OUT] An outgoing error structure.
+    /// @param error_code Error code
+    /// @param function_id Function ID of the answer
+    /// @return CAN_RESULT_ERROR
+    static can_result_t _InputError(can_frame_t &can_frame, can_error_t &error, error_code_object_t error_code,
+                                    can_function_id_t function_id = CAN_FUNC_EVENT_ERROR)
+    {
+        can_frame.initialized = false;
+        error.error_section = ERROR_SECTION_CAN_OBJECT;
+        error.error_code = error_code;
+        error.function_id = function_id;
+        return CAN_RESULT_ERROR;
+    }
+
+    /// @brief Searches for the handler of the custom function
+    /// @param function_id Custom function ID
+    /// @return Pointer to the handler or nullptr if it isn't registered
+    custom_handler_t _FindCustomHandler(can_function_id_t function_id)
+    {
+        for (const custom_function_t &custom : _custom_functions)
+        {
+            if (custom.handler != nullptr && custom.function_id == function_id)
+                return custom.handler;
+        }
+        return nullptr;
+    }
+
+    /// @brief Searches for the handler of the custom function in the handler table
+    /// @param function_id Custom function ID
+    /// @return Pointer to the handler or nullptr if the table has no handler for the function
+    object_function_handler_t _FindTableCustomHandler(can_function_id_t function_id)
+    {
+        if (_handler_table == nullptr || _handler_table->custom == nullptr ||
+            function_id >= CAN_INPUT_FUNCTIONS_COUNT || can_input_dispatch.handler_index[function_id] != CAN_INPUT_HANDLER_CUSTOM)
+            return nullptr;
+
+        return _handler_table->custom(function_id);
+    }
+
+    /// @brief Recalculates the bitmap of accepted incoming functions: functions with handlers which are allowed by the lock level.
+    ///        It is called when handlers, type or lock level of the object change.
+    void _UpdateAcceptedFunctions()
+    {
+        uint32_t accepted[2] = {0};
+        _SetFunctionBit(accepted, CAN_FUNC_LOCK_IN);
+        _SetFunctionBit(accepted, CAN_FUNC_REQUEST_IN);
+        _SetFunctionBit(accepted, CAN_FUNC_SYSTEM_REQUEST_IN);
+        if (HasExternalFunctionSet())
+            _SetFunctionBit(accepted, CAN_FUNC_SET_IN);
+        if (HasExternalFunctionToggle())
+            _SetFunctionBit(accepted, CAN_FUNC_TOGGLE_IN);
+        if (HasExternalFunctionAction())
+            _SetFunctionBit(accepted, CAN_FUNC_ACTION_IN);
+        if (IsObjectTypeSilent() && HasExternalFunctionSetRealtime())
+            _SetFunctionBit(accepted, CAN_FUNC_SET_REAL_TIME_IN);
+        for (const custom_function_t &custom : _custom_functions)
+        {
+            if (custom.handler != nullptr)
+                _SetFunctionBit(accepted, custom.function_id);
+        }
+        if (_handler_table != nullptr && _handler_table->custom != nullptr)
+        {
+            for (uint8_t func = 0; func < CAN_INPUT_FUNCTIONS_COUNT; func++)
+            {
+                if (_FindTableCustomHandler((can_function_id_t)func) != nullptr)
+                    _SetFunctionBit(accepted, (can_function_id_t)func);
+            }
+        }
+
+        for (uint8_t func = 0; func < _validated_functions_count; func++)
+        {
+            if (_IsLockedForFunction((can_function_id_t)func))
+                accepted[func >> 5] &= ~((uint32_t)1 << (func & 0x1F));
+        }
+
+        // the bitmap is read by IncomingCANFrame(): every word is updated at once
+        _accepted_functions[0] = accepted[0];
+        _accepted_functions[1] = accepted[1];
+    }
+
+    /// @brief Sets the bit of the function in the bitmap
+    /// @param bitmap Bitmap of functions
+    /// @param func_id Function ID (less than _validated_functions_count)
+    static void _SetFunctionBit(uint32_t *bitmap, can_function_id_t func_id)
+    {
+        bitmap[func_id >> 5] |= (uint32_t)1 << (func_id & 0x1F);
+    }
+
+    /// @brief Checks the length rules of the accepted incoming function
+    /// @param function_id Function ID
+    /// @param data Frame data including function ID
+    /// @param length Frame data length including function ID
+    /// @param error [OUT] Error answer for the rejected frame
+    /// @return The same as ValidateIncomingFrame()
+    can_result_t _ValidateIncomingFrameLength(can_function_id_t function_id, const uint8_t *data, uint8_t length, can_error_t &error)
+    {
+        error.error_section = ERROR_SECTION_CAN_OBJECT;
+        error.function_id = CAN_FUNC_EVENT_ERROR;
+        switch (function_id)
+        {
+        case CAN_FUNC_TOGGLE_IN:
+            if (length == 1)
+                break;
+            error.error_code = ERROR_CODE_OBJECT_TOGGLE_COMMAND_FRAME_SHOULD_NOT_HAVE_DATA;
+            return CAN_RESULT_ERROR;
+
+        case CAN_FUNC_ACTION_IN:
+            if (length == 1)
+                break;
+            error.error_code = ERROR_CODE_OBJECT_ACTION_COMMAND_FRAME_SHOULD_NOT_HAVE_DATA;
+            return CAN_RESULT_ERROR;
+
+        case CAN_FUNC_LOCK_IN:
+            error.function_id = CAN_FUNC_LOCK_OUT_ERR;
+            if (length != 2)
+            {
+                error.error_code = ERROR_CODE_OBJECT_LOCK_COMMAND_FRAME_DATA_LENGTH_ERROR;
+                return CAN_RESULT_ERROR;
+            }
+            if (!_IsItKnownLockLevel((lock_func_level_t)data[1]))
+            {
+                error.error_code = ERROR_CODE_OBJECT_LOCK_LEVEL_IS_UNKNOWN;
+                return CAN_RESULT_ERROR;
+            }
+            break;
+
+        case CAN_FUNC_REQUEST_IN:
+            // external request handlers may accept any data
+            if (length == 1 || HasExternalFunctionRequest())
+                break;
+            error.error_code = ERROR_CODE_OBJECT_INCORRECT_REQUEST;
+            return CAN_RESULT_ERROR;
+
+        case CAN_FUNC_SYSTEM_REQUEST_IN:
+            if (length == 1)
+                break;
+            error.error_code = ERROR_CODE_OBJECT_SYSTEM_REQUEST_SHOULD_NOT_HAVE_DATA;
+            return CAN_RESULT_ERROR;
+
+        case CAN_FUNC_SET_REAL_TIME_IN:
+            if (length > 2)
+                break;
+            clear_can_error_struct(error);
+            return CAN_RESULT_IGNORE;
+
+        default:
+            break;
+        }
+
+        clear_can_error_struct(error);
+        return CAN_RESULT_CAN_FRAME;
+    }
 
     /// @brief Check if specified lock level is known
     /// @param lock_code The lock level to check
@@ -1214,6 +2076,69 @@ private:
         return result;
     }
 
+    /// @brief Calculates the default timer phase from the object ID (Fibonacci hashing).
+    ///        Neighbouring IDs get phases far from each other.
+    /// @return Phase offset in milliseconds within the timer's period.
+    uint16_t _GetIdBasedTimerPhase()
+    {
+        if (_timer_period == CAN_TIMER_DISABLED || _timer_period == 0)
+            return 0;
+
+        uint16_t hash = (uint16_t)(_id * 40503u);
+        return (uint16_t)(((uint32_t)hash * _timer_period) >> 16);
+    }
+
+    /// @brief Stores the timer phase and shifts the first timer firing, if the timer has not been fired yet.
+    ///        The first frame is sent at `phase_ms` after the start, then every period.
+    /// @param phase_ms Phase offset in milliseconds.
+    void _ApplyTimerPhase(uint16_t phase_ms)
+    {
+        if (_timer_period == CAN_TIMER_DISABLED || _timer_period == 0)
+        {
+            // keep explicitly specified phase until the timer is enabled
+            _timer_phase = _timer_phase_is_auto ? 0 : phase_ms;
+            return;
+        }
+
+        _timer_phase = phase_ms % _timer_period;
+        if (!_timer_started)
+            _next_timer_time = _timer_phase;
+    }
+
+    /// @brief Returns the latest point of the timer grid (phase + k * period, counted from time 0) which is not later than the time
+    /// @param time Current time
+    /// @return The grid point. Before the first point it is 'phase - period' (unsigned overflow is intended).
+    uint32_t _GetTimerGridTime(uint32_t time)
+    {
+        if (time < _timer_phase)
+            return (uint32_t)_timer_phase - _timer_period;
+
+        return time - (time - _timer_phase) % _timer_period;
+    }
+
+    /// @brief Moves the timer to the next period after the frame (or the skipped frame).
+    ///        The timer stays on its phase grid, so tick jitter and a late start don't shift the phase.
+    /// @param time Current time
+    void _AdvanceTimer(uint32_t time)
+    {
+        _timer_started = true;
+
+        // 0 period: every tick, there is no grid
+        if (_timer_period == 0)
+        {
+            _next_timer_time = time;
+            return;
+        }
+
+        uint32_t grid_time = _GetTimerGridTime(time);
+        _next_timer_time = grid_time + _timer_period;
+
+        // frames of the frame limit mode delayed by the data skip the nearest grid point:
+        // timer frames are never sent more often than the period
+        if (!IsTimerInFloodMode() && time != grid_time)
+            _next_timer_time += _timer_period;
+    }
+
     /// @brief Checks if received frame ID is acceptable for real-time data listener
     /// @param id_received ID of the real-time frame
     /// @return 'true' if this ID is acceptable
@@ -1223,6 +2148,250 @@ private:
                (id_received != _realtime_frame_id && (uint8_t)(id_received - _realtime_frame_id - 1) <= _realtime_frames_can_lost);
     }
 
+    /// @brief Returns the current real-time interval
+    /// @return The interval to the next frame
+    uint16_t _GetRealtimeInterval()
+    {
+        return _realtime_current_interval > 0 ? _realtime_current_interval : _realtime_frame_interval;
+    }
+
+    /// @brief Returns the time from the last real-time frame to the next one: significant changes of the value
+    ///        are sent after the minimal interval
+    /// @return The interval in milliseconds
+    uint16_t _GetRealtimeDueInterval()
+    {
+        return _realtime_change_pending ? _realtime_frame_interval : _GetRealtimeInterval();
+    }
+
+    /// @brief Checks whether the value differs from the last sent one by the threshold
+    /// @param value The new value
+    /// @return 'true' if the change should be sent at once
+    bool _IsRealtimeSignificantChange(T value)
+    {
+        if (value == _realtime_last_sent_value)
+            return false;
+
+        return _GetValueDistance(value, _realtime_last_sent_value) >= _GetValueDistance(_realtime_change_threshold, (T)0);
+    }
+
+    /// @brief Returns the distance between integer values. The difference of signed values may not fit into their type,
+    ///        so it is taken modulo 2^64: it is exact for types up to 64 bits.
+    /// @param a The first value
+    /// @param b The second value
+    /// @return |a - b|
+    template <typename V>
+    static uint64_t _GetValueDistance(V a, V b)
+    {
+        return (a > b) ? (uint64_t)a - (uint64_t)b : (uint64_t)b - (uint64_t)a;
+    }
+
+    /// @brief Returns the distance between floating point values
+    /// @param a The first value
+    /// @param b The second value
+    /// @return |a - b|
+    static double _GetValueDistance(double a, double b)
+    {
+        return (a > b) ? a - b : b - a;
+    }
+
+    /// @brief Returns the distance between float values in double precision
+    /// @param a The first value
+    /// @param b The second value
+    /// @return |a - b|
+    static double _GetValueDistance(float a, float b)
+    {
+        return _GetValueDistance((double)a, (double)b);
+    }
+
+    /// @brief Selects the interval to the next real-time frame of the adaptive sender:
+    ///        the minimal one after significant changes, the doubled one while the value is steady
+    void _UpdateRealtimeAdaptiveInterval()
+    {
+        uint32_t interval = _realtime_frame_interval;
+        if (!_realtime_change_pending && _realtime_current_interval > 0)
+        {
+            interval = (uint32_t)_realtime_current_interval * 2;
+            if (interval > _realtime_max_interval)
+                interval = _realtime_max_interval;
+            if (interval < _realtime_frame_interval)
+                interval = _realtime_frame_interval;
+        }
+
+        _realtime_current_interval = (uint16_t)interval;
+        _realtime_change_pending = false;
+        _realtime_last_sent_value = GetValue(0);
+    }
+
+    /// @brief Collects the highest timer and event types among all data fields
+    /// @param max_timer_type [OUT] The highest timer type
+    /// @param max_event_type [OUT] The highest event type
+    /// @param has_normal_event [OUT] 'true' if any data field has CAN_EVENT_TYPE_NORMAL event
+    void _GetDataFieldsStates(timer_type_t &max_timer_type, event_type_t &max_event_type, bool &has_normal_event)
+    {
+        for (uint8_t i = 0; i < _item_count; i++)
+        {
+            if ((_states_of_data_fields[i] & CAN_TIMER_TYPE_MASK) > max_timer_type)
+                max_timer_type = (timer_type_t)(_states_of_data_fields[i] & (uint8_t)CAN_TIMER_TYPE_MASK);
+
+            if ((_states_of_data_fields[i] & CAN_EVENT_TYPE_MASK) > max_event_type)
+                max_event_type = (event_type_t)(_states_of_data_fields[i] & (uint8_t)CAN_EVENT_TYPE_MASK);
+
+            if ((_states_of_data_fields[i] & CAN_EVENT_TYPE_MASK) == CAN_EVENT_TYPE_NORMAL)
+                has_normal_event = true;
+        }
+    }
+
+    /// @brief Replaces the deadline if the candidate one is earlier (with respect to time counter overflow)
+    /// @param time Current time
+    /// @param candidate Candidate deadline
+    /// @param deadline [IN, OUT] The earliest deadline
+    /// @param has_deadline [IN, OUT] 'true' if the deadline is already set
+    static void _UpdateDeadline(uint32_t time, uint32_t candidate, uint32_t &deadline, bool &has_deadline)
+    {
+        if (!has_deadline || (int32_t)(candidate - time) < (int32_t)(deadline - time))
+        {
+            deadline = candidate;
+            has_deadline = true;
+        }
+    }
+
+    /// @brief Flushes the NORMAL event state of all data fields
+    void _FlushNormalEvents()
+    {
+        for (uint8_t i = 0; i < _item_count; i++)
+        {
+            if ((_states_of_data_fields[i] & CAN_EVENT_TYPE_MASK) == CAN_EVENT_TYPE_NORMAL)
+                _states_of_data_fields[i] = (_states_of_data_fields[i] & (uint8_t)CAN_TIMER_TYPE_MASK) | CAN_EVENT_TYPE_NONE;
+        }
+        _normal_event_time_set = false;
+    }
+
+    /// @brief Returns the traffic class of the automatic function
+    /// @param func Automatic function
+    /// @return Traffic class. Real-time data is never limited: listeners treat lost frames as errors.
+    static can_tx_class_t _GetAutoFunctionTxClass(can_auto_function_t func)
+    {
+        switch (func)
+        {
+        case CAN_AUTO_FUNC_EVENT:
+            return CAN_TX_CLASS_EVENT;
+
+        case CAN_AUTO_FUNC_ERROR_EVENT:
+            return CAN_TX_CLASS_ERROR;
+
+        case CAN_AUTO_FUNC_TIMER:
+            return CAN_TX_CLASS_TIMER;
+
+        case CAN_AUTO_FUNC_REALTIME:
+        case CAN_AUTO_FUNC_NONE:
+        default:
+            return CAN_TX_CLASS_UNLIMITED;
+        }
+    }
+
+    /// @brief Consumes the automatic function without sending the frame (the frame was dropped by the TX budget)
+    /// @param func Automatic function
+    /// @param time Current time
+    void _SkipAutoFunction(can_auto_function_t func, uint32_t time)
+    {
+        switch (func)
+        {
+        case CAN_AUTO_FUNC_EVENT:
+            _FlushNormalEvents();
+            break;
+
+        case CAN_AUTO_FUNC_ERROR_EVENT:
+            _last_event_time = time;
+            break;
+
+        case CAN_AUTO_FUNC_TIMER:
+            // the new data (if any) goes with the next period
+            _AdvanceTimer(time);
+            break;
+
+        case CAN_AUTO_FUNC_REALTIME:
+        case CAN_AUTO_FUNC_NONE:
+        default:
+            break;
+        }
+    }
+
+    /// @brief Performs one automatic function of the object
+    /// @param func Automatic function to perform
+    /// @param time Current time
+    /// @param can_frame [OUT] CAN frame for storing the outgoing data
+    /// @param error [OUT] An outgoing error structure. It will be filled by object if something went wrong.
+    /// @param max_timer_type The highest timer type among data fields
+    /// @param max_event_type The highest event type among data fields
+    /// @return The result of operation (should we send any CAN/Error frames or not)
+    can_result_t _ProcessAutoFunction(can_auto_function_t func, uint32_t time, can_frame_t &can_frame, can_error_t &error,
+                                      timer_type_t max_timer_type, event_type_t max_event_type)
+    {
+        can_result_t handler_result = CAN_RESULT_IGNORE;
+
+        switch (func)
+        {
+        case CAN_AUTO_FUNC_REALTIME:
+            // Automatic sending of real-time data by sender object
+            if (_realtime_max_interval > 0)
+                _UpdateRealtimeAdaptiveInterval();
+            handler_result = _PrepareRealtimeCanFrame(can_frame, error);
+            if (handler_result == CAN_RESULT_CAN_FRAME)
+            {
+                _last_realtime_frame_time = time;
+                if (_realtime_zero_point == GetValue(0))
+                {
+                    _realtime_stopped = true;
+                }
+            }
+            break;
+
+        case CAN_AUTO_FUNC_EVENT:
+            if (HasExternalFunctionEvent())
+            {
+                handler_result = _CallEventHandler(can_frame, CAN_EVENT_TYPE_NORMAL, error);
+            }
+            else
+            {
+                handler_result = _PrepareEventCanFrame(CAN_EVENT_TYPE_NORMAL, can_frame, error);
+            }
+
+            _FlushNormalEvents();
+            break;
+
+        case CAN_AUTO_FUNC_ERROR_EVENT:
+            if (HasExternalFunctionEvent())
+            {
+                handler_result = _CallEventHandler(can_frame, max_event_type, error);
+            }
+            else
+            {
+                handler_result = _PrepareEventCanFrame(max_event_type, can_frame, error);
+            }
+            _last_event_time = time;
+            break;
+
+        case CAN_AUTO_FUNC_TIMER:
+            if (HasExternalFunctionTimer())
+            {
+                handler_result = _CallTimerHandler(can_frame, max_timer_type, error);
+            }
+            else
+            {
+                handler_result = _PrepareTimerCanFrame(max_timer_type, can_frame, error);
+            }
+            _AdvanceTimer(time);
+            _has_new_data = false;
+            break;
+
+        case CAN_AUTO_FUNC_NONE:
+        default:
+            break;
+        }
+
+        return handler_result;
+    }
+
     /// @brief Fills CAN frame with event specific data
     /// @param event_type Type of the event
     /// @param can_frame CAN frame for filling with data.
@@ -1233,7 +2402,7 @@ private:
         switch (event_type)
         {
         case CAN_EVENT_TYPE_NORMAL:
-            return _PrepareRawCanFrame(can_frame, error, CAN_FUNC_EVENT_OK, _data_fields, sizeof(_data_fields));
+            return _PrepareDataCanFrame(can_frame, error, CAN_FUNC_EVENT_OK);
 
         case CAN_EVENT_TYPE_ERROR:
             can_frame.initialized = false;
@@ -1293,7 +2462,7 @@ private:
             return CAN_RESULT_ERROR;
         }
 
-        return _PrepareRawCanFrame(can_frame, error, func_id, _data_fields, sizeof(_data_fields));
+        return _PrepareDataCanFrame(can_frame, error, func_id);
     }
 
     /// @brief Fills CAN frame with request specific data.
@@ -1311,7 +2480,7 @@ private:
             return CAN_RESULT_ERROR;
         }
 
-        return _PrepareRawCanFrame(can_frame, error, CAN_FUNC_EVENT_OK, _data_fields, _item_count * sizeof(T));
+        return _PrepareDataCanFrame(can_frame, error, CAN_FUNC_EVENT_OK);
     }
 
     /// @brief Fills CAN frame with system request specific data.
@@ -1353,11 +2522,35 @@ private:
         uint8_t payload_size = sizeof(T);
         if (payload_size > CAN_FRAME_MAX_PAYLOAD - 2)
             payload_size = 0;
-        uint8_t frame_data[CAN_FRAME_MAX_PAYLOAD - 1] = {0};
+        uint8_t frame_data[CAN_FRAME_MAX_PAYLOAD] = {0};
         frame_data[0] = _realtime_frame_id;
-        memcpy(&(frame_data[1]), _data_fields, payload_size);
+        can_wire_encode(&(frame_data[1]), _data_fields, payload_size > 0 ? 1 : 0);
+        uint8_t frame_data_length = payload_size + 1;
+
+        if (_realtime_max_interval > 0 && payload_size > 0 && _realtime_interval_offset + sizeof(uint16_t) <= CAN_FRAME_MAX_PAYLOAD)
+        {
+            uint16_t interval = _GetRealtimeInterval();
+            can_wire_encode(&(frame_data[_realtime_interval_offset]), &interval, 1);
+            frame_data_length = _realtime_interval_offset + sizeof(uint16_t);
+        }
+
+        return _PrepareRawCanFrame(can_frame, error, CAN_FUNC_SET_REAL_TIME_IN, frame_data, frame_data_length);
+    }
 
-        return _PrepareRawCanFrame(can_frame, error, CAN_FUNC_SET_REAL_TIME_IN, frame_data, payload_size + 1);
+    /// @brief Fills CAN frame with data fields in the wire byte order (see CAN_WIRE_BYTE_ORDER)
+    /// @param can_frame [OUT] CAN frame for processing
+    /// @param error [OUT] An outgoing error structure. It will be filled by object if something went wrong.
+    /// @param function_id [IN] CAN function ID
+    /// @return The result of operation (should we send any CAN/Error frames or not)
+    can_result_t _PrepareDataCanFrame(can_frame_t &can_frame, can_error_t &error, can_function_id_t function_id)
+    {
+#if CAN_WIRE_SWAP_NEEDED
+        uint8_t frame_data[sizeof(_data_fields)];
+        can_wire_encode(frame_data, _data_fields, _item_count);
+        return _PrepareRawCanFrame(can_frame, error, function_id, frame_data, sizeof(frame_data));
+#else
+        return _PrepareRawCanFrame(can_frame, error, function_id, _data_fields, sizeof(_data_fields));
+#endif
     }
 
     /// @brief Fills CAN frame with specified data
@@ -1398,3 +2591,6 @@ private:
         return CAN_RESULT_CAN_FRAME;
     };
 };
+
+template <typename T, uint8_t _item_count>
+constexpr typename CANObject<T, _item_count>::input_handler_t CANObject<T, _item_count>::_input_handlers[CAN_INPUT_HANDLER_COUNT];
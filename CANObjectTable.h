@@ -0,0 +1,134 @@
+#pragma once
+
+#include <stdint.h>
+#include "CAN_common.h"
+#include "CANObject.h"
+
+// Entry of the constant object table
+struct can_object_table_entry_t
+{
+    can_object_id_t id;
+    CANObjectInterface *object;
+};
+
+// These functions are never defined: their calls make invalid constant tables fail to compile
+// (and non-constant ones fail to link).
+void can_object_table_error_duplicate_id();
+void can_object_table_error_null_object();
+
+/// @brief Binary search in the dispatch index
+/// @param ids Array of IDs in the order of processing
+/// @param sorted_index Indexes of the IDs sorted by ID
+/// @param count The number of IDs
+/// @param id ID to search
+/// @return Index of the ID or -1 if it wasn't found
+constexpr int16_t can_object_table_find_index(const can_object_id_t *ids, const uint8_t *sorted_index, uint8_t count, can_object_id_t id)
+{
+    uint8_t low = 0;
+    uint8_t high = count;
+    while (low < high)
+    {
+        uint8_t mid = low + (high - low) / 2;
+        can_object_id_t mid_id = ids[sorted_index[mid]];
+        if (mid_id == id)
+            return sorted_index[mid];
+
+        if (mid_id < id)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return -1;
+}
+
+/******************************************************************************************
+ ******************************************************************************************/
+/// @brief CANObjectTable is the registry of CANObjects built at compile time.
+///        IDs are checked for uniqueness and the dispatch index (entries sorted by ID) is precomputed,
+///        so the constexpr table is placed in flash and CANManager uses it without any registration.
+///        IDs of the table must be the same as IDs passed to the constructors of the objects. GetId() is virtual, so it can't be
+///        called at compile time: CANManager checks the IDs with assert() at its first tick, when all objects are constructed.
+/// @tparam _count — The number of CANObjects in the table
+template <uint8_t _count>
+class CANObjectTable
+{
+    static_assert(_count > 0); // 0 objects is not allowed
+public:
+    /// @brief Builds the table
+    /// @param entries IDs and pointers of CANObjects in the order of their processing
+    constexpr CANObjectTable(const can_object_table_entry_t (&entries)[_count])
+        : _objects(), _ids(), _sorted_index()
+    {
+        for (uint8_t i = 0; i < _count; i++)
+        {
+            if (entries[i].object == nullptr)
+                can_object_table_error_null_object();
+
+            _objects[i] = entries[i].object;
+            _ids[i] = entries[i].id;
+
+            // insertion sort of the dispatch index
+            uint8_t pos = i;
+            while (pos > 0 && entries[_sorted_index[pos - 1]].id > entries[i].id)
+            {
+                _sorted_index[pos] = _sorted_index[pos - 1];
+                pos--;
+            }
+            if (pos > 0 && entries[_sorted_index[pos - 1]].id == entries[i].id)
+                can_object_table_error_duplicate_id();
+            _sorted_index[pos] = i;
+        }
+    }
+
+    /// @brief Returns the number of CANObjects in the table
+    /// @return The number of CANObjects
+    constexpr uint8_t GetCount() const
+    {
+        return _count;
+    }
+
+    /// @brief Returns the array of CANObject pointers in the order of processing
+    /// @return Pointer to the array
+    constexpr CANObjectInterface *const *GetObjects() const
+    {
+        return _objects;
+    }
+
+    /// @brief Returns the array of IDs in the order of processing
+    /// @return Pointer to the array
+    constexpr const can_object_id_t *GetIds() const
+    {
+        return _ids;
+    }
+
+    /// @brief Returns the dispatch index: indexes of the objects sorted by ID
+    /// @return Pointer to the array
+    constexpr const uint8_t *GetSortedIndex() const
+    {
+        return _sorted_index;
+    }
+
+    /// @brief Searches for the CANObject by ID (binary search)
+    /// @param id ID of the CANObject
+    /// @return Index of the CANObject or -1 if it wasn't found
+    constexpr int16_t FindIndex(can_object_id_t id) const
+    {
+        return can_object_table_find_index(_ids, _sorted_index, _count, id);
+    }
+
+private:
+    CANObjectInterface *_objects[_count];
+    can_object_id_t _ids[_count];
+    uint8_t _sorted_index[_count];
+};
+
+/// @brief Builds the constant object table: constexpr auto objects = make_can_object_table({{0x101, &obj1}, {0x102, &obj2}});
+///        Duplicate IDs and null pointers break compilation of constexpr tables.
+/// @tparam _count — The number of CANObjects (deduced)
+/// @param entries IDs and pointers of CANObjects in the order of their processing
+/// @return The table
+template <uint8_t _count>
+constexpr CANObjectTable<_count> make_can_object_table(const can_object_table_entry_t (&entries)[_count])
+{
+    return CANObjectTable<_count>(entries);
+}
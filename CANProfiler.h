@@ -0,0 +1,343 @@
+#pragma once
+
+#include <stdint.h>
+#include "CAN_common.h"
+
+#if defined(__linux__)
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#endif
+
+#ifndef CAN_PROFILER_BUCKETS
+#define CAN_PROFILER_BUCKETS 16 // log2 buckets of histograms: the last one counts all durations of 2^(N-2) cycles and longer
+#endif
+
+// Profiled code of CANObjects: handlers of incoming functions (values of can_input_handler_t) and automatic functions
+enum can_profile_slot_t : uint8_t
+{
+    CAN_PROFILE_SLOT_REALTIME = CAN_INPUT_HANDLER_COUNT + 0,
+    CAN_PROFILE_SLOT_EVENT = CAN_INPUT_HANDLER_COUNT + 1,
+    CAN_PROFILE_SLOT_ERROR_EVENT = CAN_INPUT_HANDLER_COUNT + 2,
+    CAN_PROFILE_SLOT_TIMER = CAN_INPUT_HANDLER_COUNT + 3,
+
+    CAN_PROFILE_SLOT_COUNT = CAN_INPUT_HANDLER_COUNT + 4,
+};
+
+// Profiled phases of CANManager::Process()
+enum can_profile_phase_t : uint8_t
+{
+    CAN_PROFILE_PHASE_RX = 0x00, // processing of buffered incoming frames
+    CAN_PROFILE_PHASE_TX = 0x01, // automatic functions of CANObjects and sending of their frames
+
+    CAN_PROFILE_PHASE_COUNT = 0x02,
+};
+
+// Kinds of histograms
+enum can_profile_kind_t : uint8_t
+{
+    CAN_PROFILE_KIND_OBJECT = 0x00, // all profiled code of one CANObject
+    CAN_PROFILE_KIND_SLOT = 0x01,   // one slot (can_profile_slot_t) of all CANObjects
+    CAN_PROFILE_KIND_PHASE = 0x02,  // one phase (can_profile_phase_t) of CANManager
+
+    CAN_PROFILE_KIND_INFO = 0xFF, // the size of the profiler (statistics object only)
+};
+
+// Histogram of execution times in cycles of the profiler counter
+struct can_profile_histogram_t
+{
+    uint32_t count = 0; // the number of measurements
+    uint32_t max = 0;   // the longest measurement
+    uint32_t last = 0;  // the last measurement
+    uint16_t buckets[CAN_PROFILER_BUCKETS] = {0}; // bucket 0: 0 cycles, bucket N: [2^(N-1), 2^N) cycles; saturated counters
+};
+
+/// @brief Returns the bucket of the histogram for the duration
+/// @param cycles Duration in cycles
+/// @return Index of the bucket
+inline uint8_t can_profile_bucket(uint32_t cycles)
+{
+    uint8_t bucket = (cycles == 0) ? 0 : 32 - __builtin_clz(cycles);
+    return (bucket < CAN_PROFILER_BUCKETS) ? bucket : CAN_PROFILER_BUCKETS - 1;
+}
+
+/// @brief Returns the profiling slot of the automatic function
+/// @param func Automatic function (one bit of can_auto_function_t)
+/// @return The slot
+inline can_profile_slot_t can_profile_slot_of(can_auto_function_t func)
+{
+    return (can_profile_slot_t)(CAN_PROFILE_SLOT_REALTIME + __builtin_ctz(func));
+}
+
+/*************************************************************************************************
+ *
+ * Cycle counters. All of them have can_clock_function_t type, so they also fit CANManager::SetProcessClock().
+ *
+ *************************************************************************************************/
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_8M_MAIN__) || defined(__ARM_ARCH_8_1M_MAIN__)
+/// @brief Enables DWT cycle counter of Cortex-M3/M4/M7/M33
+inline void can_cycles_dwt_enable()
+{
+    *(volatile uint32_t *)0xE000EDFC |= (1UL << 24); // CoreDebug->DEMCR: TRCENA
+    *(volatile uint32_t *)0xE0001004 = 0;            // DWT->CYCCNT
+    *(volatile uint32_t *)0xE0001000 |= 1UL;         // DWT->CTRL: CYCCNTENA
+}
+
+/// @brief Returns DWT cycle counter. can_cycles_dwt_enable() should be called once before.
+/// @return CPU cycles
+inline uint32_t can_cycles_dwt()
+{
+    return *(volatile uint32_t *)0xE0001004;
+}
+#endif
+
+#if defined(__linux__)
+/// @brief Returns monotonic clock in nanoseconds
+/// @return Nanoseconds (wraps every 4.29 s)
+inline uint32_t can_cycles_clock_gettime()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)ts.tv_sec * 1000000000UL + (uint32_t)ts.tv_nsec;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+/// @brief Returns time stamp counter of x86 CPU
+/// @return TSC cycles (lower 32 bits)
+inline uint32_t can_cycles_tsc()
+{
+    return (uint32_t)__rdtsc();
+}
+#endif
+#endif // __linux__
+
+/******************************************************************************************
+ *
+ ******************************************************************************************/
+class CANProfilerInterface
+{
+public:
+    virtual ~CANProfilerInterface() = default;
+
+    /// @brief Returns current value of the cycle counter
+    /// @return Cycles
+    virtual uint32_t GetCycles() = 0;
+
+    /// @brief Records execution time of the CANObject code
+    /// @param id ID of the CANObject
+    /// @param slot Profiled code
+    /// @param start_cycles Value of the cycle counter before the code
+    virtual void RecordSlot(can_object_id_t id, can_profile_slot_t slot, uint32_t start_cycles) = 0;
+
+    /// @brief Records execution time of the CANManager phase
+    /// @param phase Profiled phase
+    /// @param start_cycles Value of the cycle counter before the phase
+    virtual void RecordPhase(can_profile_phase_t phase, uint32_t start_cycles) = 0;
+
+    /// @brief Returns the number of histograms of the kind
+    /// @param kind Kind of histograms
+    /// @return The number of histograms
+    virtual uint8_t GetHistogramsCount(can_profile_kind_t kind) = 0;
+
+    /// @brief Returns the histogram
+    /// @param kind Kind of the histogram
+    /// @param index Index of the histogram: index of the object, slot or phase
+    /// @param histogram [OUT] The histogram
+    /// @param key [OUT] ID of the CANObject, slot or phase
+    /// @return 'true' if the histogram exists
+    virtual bool GetHistogram(can_profile_kind_t kind, uint8_t index, can_profile_histogram_t &histogram, uint16_t &key) = 0;
+
+    /// @brief Returns the histogram of the CANObject
+    /// @param id ID of the CANObject
+    /// @param histogram [OUT] The histogram
+    /// @return 'true' if the CANObject was profiled
+    virtual bool GetObjectHistogram(can_object_id_t id, can_profile_histogram_t &histogram) = 0;
+
+    /// @brief Clears all histograms
+    virtual void Reset() = 0;
+};
+
+/******************************************************************************************
+ ******************************************************************************************/
+/// @brief CANProfiler collects execution times of CANObject handlers and CANManager phases into log2 histograms:
+///        per CANObject, per slot (handler of incoming function or automatic function) and per phase.
+///        Times are measured with the pluggable cycle counter, so their units are the units of the counter.
+///        CANManager passes the registered profiler to its CANObjects.
+/// @tparam _max_objects — The maximum number of profiled CANObjects. Other objects are counted in slots only.
+template <uint8_t _max_objects = 16>
+class CANProfiler : public CANProfilerInterface
+{
+public:
+    /// @brief Default constructor is disabled
+    CANProfiler() = delete;
+
+    /// @brief Creates the profiler
+    /// @param cycle_counter Pointer to the function which returns the cycle counter (e.g. can_cycles_dwt)
+    CANProfiler(can_clock_function_t cycle_counter)
+        : _cycle_counter(cycle_counter){};
+
+    /// @brief Returns current value of the cycle counter
+    /// @return Cycles
+    virtual uint32_t GetCycles() override
+    {
+        return _cycle_counter();
+    }
+
+    /// @brief Records execution time of the CANObject code
+    /// @param id ID of the CANObject
+    /// @param slot Profiled code
+    /// @param start_cycles Value of the cycle counter before the code
+    virtual void RecordSlot(can_object_id_t id, can_profile_slot_t slot, uint32_t start_cycles) override
+    {
+        uint32_t cycles = _cycle_counter() - start_cycles;
+
+        if (slot < CAN_PROFILE_SLOT_COUNT)
+            _Record(_slots[slot], cycles);
+
+        int16_t obj_idx = _FindObjectIndex(id);
+        if (obj_idx >= 0)
+            _Record(_objects[obj_idx], cycles);
+    }
+
+    /// @brief Records execution time of the CANManager phase
+    /// @param phase Profiled phase
+    /// @param start_cycles Value of the cycle counter before the phase
+    virtual void RecordPhase(can_profile_phase_t phase, uint32_t start_cycles) override
+    {
+        uint32_t cycles = _cycle_counter() - start_cycles;
+
+        if (phase < CAN_PROFILE_PHASE_COUNT)
+            _Record(_phases[phase], cycles);
+    }
+
+    /// @brief Returns the number of histograms of the kind
+    /// @param kind Kind of histograms
+    /// @return The number of histograms
+    virtual uint8_t GetHistogramsCount(can_profile_kind_t kind) override
+    {
+        switch (kind)
+        {
+        case CAN_PROFILE_KIND_OBJECT:
+            return _objects_idx;
+        case CAN_PROFILE_KIND_SLOT:
+            return CAN_PROFILE_SLOT_COUNT;
+        case CAN_PROFILE_KIND_PHASE:
+            return CAN_PROFILE_PHASE_COUNT;
+        default:
+            return 0;
+        }
+    }
+
+    /// @brief Returns the histogram
+    /// @param kind Kind of the histogram
+    /// @param index Index of the histogram: index of the object, slot or phase
+    /// @param histogram [OUT] The histogram
+    /// @param key [OUT] ID of the CANObject, slot or phase
+    /// @return 'true' if the histogram exists
+    virtual bool GetHistogram(can_profile_kind_t kind, uint8_t index, can_profile_histogram_t &histogram, uint16_t &key) override
+    {
+        if (index >= GetHistogramsCount(kind))
+            return false;
+
+        switch (kind)
+        {
+        case CAN_PROFILE_KIND_OBJECT:
+            histogram = _objects[index];
+            key = _object_ids[index];
+            return true;
+        case CAN_PROFILE_KIND_SLOT:
+            histogram = _slots[index];
+            key = index;
+            return true;
+        case CAN_PROFILE_KIND_PHASE:
+            histogram = _phases[index];
+            key = index;
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    /// @brief Returns the histogram of the CANObject
+    /// @param id ID of the CANObject
+    /// @param histogram [OUT] The histogram
+    /// @return 'true' if the CANObject was profiled
+    virtual bool GetObjectHistogram(can_object_id_t id, can_profile_histogram_t &histogram) override
+    {
+        for (uint8_t i = 0; i < _objects_idx; i++)
+        {
+            if (_object_ids[i] == id)
+            {
+                histogram = _objects[i];
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /// @brief Clears all histograms. Profiled CANObjects are kept.
+    virtual void Reset() override
+    {
+        for (uint8_t i = 0; i < _objects_idx; i++)
+            _objects[i] = {};
+        for (uint8_t i = 0; i < CAN_PROFILE_SLOT_COUNT; i++)
+            _slots[i] = {};
+        for (uint8_t i = 0; i < CAN_PROFILE_PHASE_COUNT; i++)
+            _phases[i] = {};
+    }
+
+private:
+    can_clock_function_t _cycle_counter = nullptr;
+
+    can_profile_histogram_t _slots[CAN_PROFILE_SLOT_COUNT] = {};
+    can_profile_histogram_t _phases[CAN_PROFILE_PHASE_COUNT] = {};
+
+    // CANObjects are added on their first measurement
+    can_profile_histogram_t _objects[_max_objects > 0 ? _max_objects : 1] = {};
+    can_object_id_t _object_ids[_max_objects > 0 ? _max_objects : 1] = {0};
+    uint8_t _objects_idx = 0;
+    uint8_t _last_object_idx = 0;
+
+    /// @brief Adds the measurement to the histogram
+    /// @param histogram The histogram
+    /// @param cycles Duration in cycles
+    static void _Record(can_profile_histogram_t &histogram, uint32_t cycles)
+    {
+        histogram.count++;
+        histogram.last = cycles;
+        if (cycles > histogram.max)
+            histogram.max = cycles;
+
+        uint16_t &bucket = histogram.buckets[can_profile_bucket(cycles)];
+        if (bucket < UINT16_MAX)
+            bucket++;
+    }
+
+    /// @brief Searches for the histogram of the CANObject, the new one is taken for unknown CANObject
+    /// @param id ID of the CANObject
+    /// @return Index of the histogram or -1 if all histograms are taken
+    int16_t _FindObjectIndex(can_object_id_t id)
+    {
+        // handlers of the same object are usually measured one after another
+        if (_last_object_idx < _objects_idx && _object_ids[_last_object_idx] == id)
+            return _last_object_idx;
+
+        for (uint8_t i = 0; i < _objects_idx; i++)
+        {
+            if (_object_ids[i] == id)
+            {
+                _last_object_idx = i;
+                return i;
+            }
+        }
+
+        if (_objects_idx >= _max_objects)
+            return -1;
+
+        _object_ids[_objects_idx] = id;
+        _last_object_idx = _objects_idx;
+        return _objects_idx++;
+    }
+};
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <stdint.h>
+#include "CAN_common.h"
+#include "CAN_wire.h"
+#include "CANObject.h"
+#include "CANProfiler.h"
+
+/******************************************************************************************
+ ******************************************************************************************/
+/// @brief CANProfilerObject is the statistics system object (BlockStats): it answers REQUEST frames with histograms of the profiler.
+///        Request data: { kind, index, page }, the answer (CAN_FUNC_EVENT_OK): { kind, index, page, value[4] }.
+///        Pages of the histogram: 0 — key (ID of the CANObject, slot or phase), 1 — count, 2 — max, 3 — last,
+///        4 + N — buckets 2N (lower 16 bits of the value) and 2N + 1 (upper 16 bits).
+///        Request without data returns { CAN_PROFILE_KIND_INFO, objects, slots, phases, buckets }.
+class CANProfilerObject : public CANObject<uint8_t, 1>
+{
+public:
+    /// @brief Creates the statistics object
+    /// @param id ID of the object
+    /// @param profiler The profiler to read
+    CANProfilerObject(can_object_id_t id, CANProfilerInterface &profiler)
+        : CANObject<uint8_t, 1>(id), _stats_profiler(profiler)
+    {
+        _stats_handlers.context = this;
+        _stats_handlers.request = _RequestHandler;
+        SetObjectType(CAN_OBJECT_TYPE_SYSTEM_BLOCK_STATS);
+        SetHandlerTable(&_stats_handlers);
+    };
+
+    virtual ~CANProfilerObject() = default;
+
+private:
+    static constexpr uint8_t _first_bucket_page = 4;
+
+    CANProfilerInterface &_stats_profiler;
+    can_handler_table_t _stats_handlers = {};
+
+    /// @brief Handler of REQUEST frames
+    static can_result_t _RequestHandler(CANObjectInterface &/*object*/, can_frame_t &can_frame, can_error_t &error, void *context)
+    {
+        return ((CANProfilerObject *)context)->_PrepareStatsCanFrame(can_frame, error);
+    }
+
+    /// @brief Fills the answer with the requested page of the histogram
+    /// @param can_frame Incoming and outgoing CAN frame.
+    /// @param error An outgoing error structure. It will be filled by object if something went wrong.
+    /// @return The result of operation (should we send any CAN/Error frames or not)
+    can_result_t _PrepareStatsCanFrame(can_frame_t &can_frame, can_error_t &error)
+    {
+        uint8_t answer[CAN_FRAME_MAX_PAYLOAD] = {0};
+
+        if (can_frame.raw_data_length == 1)
+        {
+            answer[0] = CAN_PROFILE_KIND_INFO;
+            answer[1] = _stats_profiler.GetHistogramsCount(CAN_PROFILE_KIND_OBJECT);
+            answer[2] = _stats_profiler.GetHistogramsCount(CAN_PROFILE_KIND_SLOT);
+            answer[3] = _stats_profiler.GetHistogramsCount(CAN_PROFILE_KIND_PHASE);
+            answer[4] = CAN_PROFILER_BUCKETS;
+            return FillRawCanFrame(can_frame, error, CAN_FUNC_EVENT_OK, answer, 5);
+        }
+
+        can_profile_histogram_t histogram;
+        uint16_t key = 0;
+        uint8_t page = can_frame.data[2];
+        if (can_frame.raw_data_length != 4 ||
+            !_stats_profiler.GetHistogram((can_profile_kind_t)can_frame.data[0], can_frame.data[1], histogram, key) ||
+            page >= _first_bucket_page + (CAN_PROFILER_BUCKETS + 1) / 2)
+        {
+            can_frame.initialized = false;
+            error.function_id = CAN_FUNC_EVENT_ERROR;
+            error.error_section = ERROR_SECTION_CAN_OBJECT;
+            error.error_code = ERROR_CODE_OBJECT_INCORRECT_REQUEST;
+            return CAN_RESULT_ERROR;
+        }
+
+        uint32_t value = 0;
+        switch (page)
+        {
+        case 0:
+            value = key;
+            break;
+        case 1:
+            value = histogram.count;
+            break;
+        case 2:
+            value = histogram.max;
+            break;
+        case 3:
+            value = histogram.last;
+            break;
+        default:
+        {
+            uint8_t bucket = (page - _first_bucket_page) * 2;
+            value = histogram.buckets[bucket];
+            if (bucket + 1 < CAN_PROFILER_BUCKETS)
+                value |= (uint32_t)histogram.buckets[bucket + 1] << 16;
+            break;
+        }
+        }
+
+        answer[0] = can_frame.data[0];
+        answer[1] = can_frame.data[1];
+        answer[2] = page;
+        can_wire_encode(&answer[3], &value, 1);
+        return FillRawCanFrame(can_frame, error, CAN_FUNC_EVENT_OK, answer, 7);
+    }
+};
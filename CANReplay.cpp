@@ -0,0 +1,211 @@
+#include "CANReplay.h"
+
+#if defined(__linux__)
+
+#include <string.h>
+#include <chrono>
+#include <thread>
+
+std::atomic<CANReplay *> CANReplay::_running[CAN_REPLAY_MAX_RUNNING] = {};
+const can_send_batch_function_t CANReplay::_send_batch_trampolines[CAN_REPLAY_MAX_RUNNING] = {
+    _SendBatchTrampoline<0>, _SendBatchTrampoline<1>, _SendBatchTrampoline<2>, _SendBatchTrampoline<3>};
+static_assert(CAN_REPLAY_MAX_RUNNING == 4); // one trampoline per slot
+
+void CANReplay::SetSpeed(float speed)
+{
+    _speed = (speed > 0.0f) ? speed : 0.0f;
+}
+
+void CANReplay::SetProcessInterval(uint16_t interval_ms)
+{
+    _process_interval_ms = (interval_ms > 0) ? interval_ms : 1;
+}
+
+void CANReplay::SetStartTime(uint32_t start_time_ms)
+{
+    _start_time_ms = start_time_ms;
+    _has_start_time = true;
+}
+
+void CANReplay::SetTailTime(uint32_t tail_time_ms)
+{
+    _tail_time_ms = tail_time_ms;
+}
+
+void CANReplay::SetManagerId(uint8_t manager_id)
+{
+    _manager_id = manager_id;
+}
+
+void CANReplay::SetOutputWriter(CANCaptureWriterInterface *writer)
+{
+    _writer = writer;
+}
+
+bool CANReplay::Run(const can_capture_record_t *records, uint32_t count, can_replay_mode_t mode, can_replay_result_t &result)
+{
+    result = {};
+    if (records == nullptr && count > 0)
+        return false;
+
+    uint8_t slot = _TakeRunningSlot();
+    if (slot == CAN_REPLAY_MAX_RUNNING)
+        return false;
+
+    _mode = mode;
+    _result = &result;
+    _records = records;
+    _records_count = count;
+    _expected_idx = 0;
+
+    // batched sending has priority over the other sending functions, so only it is replaced
+    can_send_batch_function_t send_batch_func = _can_manager.GetBatchSendFunction();
+    _can_manager.RegisterBatchSendFunction(_send_batch_trampolines[slot]);
+
+    uint32_t start_time = _has_start_time ? _start_time_ms : ((count > 0) ? records[0].time_ms : 0);
+    uint32_t end_time = ((count > 0) ? records[count - 1].time_ms : 0) + _tail_time_ms;
+    result.start_time_ms = start_time;
+
+    auto wall_start = std::chrono::steady_clock::now();
+    uint32_t record_idx = 0;
+    _time = start_time;
+    while (true)
+    {
+        // incoming frames recorded up to the current virtual time
+        while (record_idx < count && (int32_t)(records[record_idx].time_ms - _time) <= 0)
+        {
+            const can_capture_record_t &record = records[record_idx++];
+            if (record.manager_id != _manager_id ||
+                (record.flags & CAN_CAPTURE_DIRECTION_MASK) != CAN_CAPTURE_DIRECTION_RX)
+                continue;
+
+            uint8_t data[sizeof(record.raw_data)];
+            uint8_t length = record.flags & CAN_CAPTURE_LENGTH_MASK;
+            if (length > sizeof(data))
+                length = sizeof(data);
+            memcpy(data, record.raw_data, length);
+
+            if (_can_manager.IncomingCANFrame(record.object_id, data, length))
+                result.frames_injected++;
+            else
+                result.frames_rejected++;
+        }
+
+        if (_speed > 0.0f)
+        {
+            auto virtual_elapsed = std::chrono::duration<double, std::milli>((_time - start_time) / _speed);
+            std::this_thread::sleep_until(wall_start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(virtual_elapsed));
+        }
+
+        _can_manager.Process(_time);
+
+        if ((int32_t)(_time - end_time) >= 0)
+            break;
+
+        _time += _process_interval_ms;
+    }
+    result.end_time_ms = _time;
+
+    if (_mode == CAN_REPLAY_MODE_COMPARE)
+    {
+        for (; _expected_idx < _records_count; _expected_idx++)
+        {
+            if (_IsExpectedRecord(_records[_expected_idx]))
+                result.frames_missing++;
+        }
+    }
+
+    // the frames left in the batch still go to the replay
+    _can_manager.RegisterBatchSendFunction(send_batch_func);
+    _running[slot].store(nullptr, std::memory_order_release);
+    _result = nullptr;
+
+    return _mode != CAN_REPLAY_MODE_COMPARE || (result.frames_mismatched == 0 && result.frames_missing == 0);
+}
+
+uint8_t CANReplay::_TakeRunningSlot()
+{
+    uint8_t slot = CAN_REPLAY_MAX_RUNNING;
+    for (uint8_t i = 0; i < CAN_REPLAY_MAX_RUNNING && slot == CAN_REPLAY_MAX_RUNNING; i++)
+    {
+        CANReplay *free_slot = nullptr;
+        if (_running[i].compare_exchange_strong(free_slot, this, std::memory_order_acq_rel))
+            slot = i;
+    }
+    if (slot == CAN_REPLAY_MAX_RUNNING)
+        return slot;
+
+    // the sending function of the CANManager is already replaced by another replay
+    for (uint8_t i = 0; i < CAN_REPLAY_MAX_RUNNING; i++)
+    {
+        CANReplay *replay = _running[i].load(std::memory_order_acquire);
+        if (i != slot && replay != nullptr && &replay->_can_manager == &_can_manager)
+        {
+            _running[slot].store(nullptr, std::memory_order_release);
+            return CAN_REPLAY_MAX_RUNNING;
+        }
+    }
+
+    return slot;
+}
+
+template <uint8_t _slot>
+void CANReplay::_SendBatchTrampoline(can_frame_t *frames, uint8_t count)
+{
+    CANReplay *replay = _running[_slot].load(std::memory_order_acquire);
+    for (uint8_t i = 0; i < count && replay != nullptr; i++)
+        replay->_OnOutgoingFrame(frames[i].object_id, frames[i].raw_data, frames[i].raw_data_length);
+}
+
+void CANReplay::_OnOutgoingFrame(can_object_id_t id, const uint8_t *data, uint8_t length)
+{
+    _result->frames_sent++;
+
+    if (_mode == CAN_REPLAY_MODE_RECORD)
+    {
+        if (_writer == nullptr)
+            return;
+
+        can_capture_record_t record = {};
+        record.time_ms = _time;
+        record.object_id = id;
+        record.manager_id = _manager_id;
+        if (length > sizeof(record.raw_data))
+            length = sizeof(record.raw_data);
+        record.flags = CAN_CAPTURE_DIRECTION_TX | length;
+        memcpy(record.raw_data, data, length);
+        _writer->Write(&record, 1);
+        return;
+    }
+
+    // compare mode: the next outgoing frame of the trace is expected; times aren't compared because of tick quantization
+    while (_expected_idx < _records_count && !_IsExpectedRecord(_records[_expected_idx]))
+        _expected_idx++;
+
+    bool is_matched = false;
+    if (_expected_idx < _records_count)
+    {
+        const can_capture_record_t &expected = _records[_expected_idx++];
+        is_matched = expected.object_id == id &&
+                     (expected.flags & CAN_CAPTURE_LENGTH_MASK) == length &&
+                     memcmp(expected.raw_data, data, length) == 0;
+    }
+
+    if (is_matched)
+    {
+        _result->frames_matched++;
+        return;
+    }
+
+    if (_result->first_mismatch_index == CAN_REPLAY_NO_MISMATCH)
+        _result->first_mismatch_index = _result->frames_sent - 1;
+    _result->frames_mismatched++;
+}
+
+bool CANReplay::_IsExpectedRecord(const can_capture_record_t &record)
+{
+    return record.manager_id == _manager_id &&
+           (record.flags & CAN_CAPTURE_DIRECTION_MASK) == CAN_CAPTURE_DIRECTION_TX;
+}
+
+#endif // __linux__
@@ -0,0 +1,127 @@
+#pragma once
+
+// Host-side replay of recorded traffic into CANManager on a virtual clock.
+#if defined(__linux__)
+
+#include <stdint.h>
+#include <atomic>
+#include "CANManager.h"
+#include "CANCapture.h"
+
+#define CAN_REPLAY_NO_MISMATCH UINT32_MAX
+#define CAN_REPLAY_MAX_RUNNING 4 // the number of CANReplays which can run at the same time (on different CANManagers)
+
+enum can_replay_mode_t : uint8_t
+{
+    CAN_REPLAY_MODE_RECORD = 0x00,  // outgoing frames are passed to the output writer
+    CAN_REPLAY_MODE_COMPARE = 0x01, // outgoing frames are compared with the outgoing frames of the trace
+};
+
+// Results of the replay
+struct can_replay_result_t
+{
+    uint32_t frames_injected = 0; // incoming frames accepted by CANManager
+    uint32_t frames_rejected = 0; // incoming frames rejected by CANManager
+    uint32_t frames_sent = 0;     // outgoing frames produced by CANManager
+    uint32_t frames_matched = 0;
+    uint32_t frames_mismatched = 0;                      // including unexpected extra frames
+    uint32_t frames_missing = 0;                         // expected frames which weren't produced
+    uint32_t first_mismatch_index = CAN_REPLAY_NO_MISMATCH; // index of the first mismatched outgoing frame
+    uint32_t start_time_ms = 0;
+    uint32_t end_time_ms = 0;
+};
+
+/******************************************************************************************
+ ******************************************************************************************/
+/// @brief CANReplay feeds recorded frames into CANManager. Incoming frames of the trace are passed to IncomingCANFrame()
+///        at their recorded times of the virtual clock, Process() is called every tick of the virtual clock.
+///        The batch sending function of CANManager is replaced during Run(), so outgoing frames are recorded
+///        or compared with the trace, and restored when Run() returns.
+///        The same trace and the same CANManager configuration always produce the same outgoing frames.
+///        Only one CANReplay can run on a CANManager at a time.
+class CANReplay
+{
+public:
+    /// @brief Creates CANReplay
+    /// @param can_manager CANManager to drive. It should be freshly created and have all objects registered.
+    CANReplay(CANManagerInterface &can_manager)
+        : _can_manager(can_manager){};
+
+    ~CANReplay() = default;
+
+    /// @brief Sets replay speed
+    /// @param speed Speed factor relative to the recorded time (e.g. 10.0 is ten times faster), 0 is as fast as possible (default)
+    void SetSpeed(float speed);
+
+    /// @brief Sets interval of Process() calls on the virtual clock
+    /// @param interval_ms Interval in milliseconds (1 by default)
+    void SetProcessInterval(uint16_t interval_ms);
+
+    /// @brief Sets start time of the virtual clock. It should be the time when the recorded CANManager started
+    ///        to reproduce its timers exactly. By default the clock starts at the time of the first record.
+    /// @param start_time_ms Start time in milliseconds
+    void SetStartTime(uint32_t start_time_ms);
+
+    /// @brief Sets duration of replay after the last frame of the trace
+    /// @param tail_time_ms Duration in milliseconds (0 by default)
+    void SetTailTime(uint32_t tail_time_ms);
+
+    /// @brief Selects frames of the trace by the manager ID (frames of other CAN buses are ignored)
+    /// @param manager_id Manager ID from the trace records
+    void SetManagerId(uint8_t manager_id);
+
+    /// @brief Sets writer for outgoing frames (record mode)
+    /// @param writer Pointer to the writer or nullptr
+    void SetOutputWriter(CANCaptureWriterInterface *writer);
+
+    /// @brief Replays the trace
+    /// @param records Records of the trace sorted by time (e.g. from CANCaptureFileReader)
+    /// @param count The number of records
+    /// @param mode Record or compare mode
+    /// @param result [OUT] Results of the replay
+    /// @return 'true' if the replay finished and no mismatches were found in compare mode
+    bool Run(const can_capture_record_t *records, uint32_t count, can_replay_mode_t mode, can_replay_result_t &result);
+
+private:
+    CANManagerInterface &_can_manager;
+
+    float _speed = 0.0f;
+    uint16_t _process_interval_ms = 1;
+    uint32_t _tail_time_ms = 0;
+    uint32_t _start_time_ms = 0;
+    bool _has_start_time = false;
+    uint8_t _manager_id = 0;
+    CANCaptureWriterInterface *_writer = nullptr;
+
+    // state of the running replay
+    can_replay_mode_t _mode = CAN_REPLAY_MODE_RECORD;
+    can_replay_result_t *_result = nullptr;
+    const can_capture_record_t *_records = nullptr;
+    uint32_t _records_count = 0;
+    uint32_t _expected_idx = 0; // the next outgoing record of the trace to compare with
+    uint32_t _time = 0;         // virtual clock
+
+    // running replays: the sending function of the slot passes outgoing frames to the replay of the slot
+    static std::atomic<CANReplay *> _running[CAN_REPLAY_MAX_RUNNING];
+    static const can_send_batch_function_t _send_batch_trampolines[CAN_REPLAY_MAX_RUNNING];
+
+    template <uint8_t _slot>
+    static void _SendBatchTrampoline(can_frame_t *frames, uint8_t count);
+
+    /// @brief Takes a free slot of the running replays
+    /// @return Slot index or CAN_REPLAY_MAX_RUNNING if all slots are taken or the CANManager is already replayed
+    uint8_t _TakeRunningSlot();
+
+    /// @brief Handles outgoing frame of CANManager
+    /// @param id CAN frame ID
+    /// @param data Frame data including function ID
+    /// @param length Frame data length including function ID
+    void _OnOutgoingFrame(can_object_id_t id, const uint8_t *data, uint8_t length);
+
+    /// @brief Checks if the record is the outgoing frame of the selected CAN bus
+    /// @param record Record to check
+    /// @return 'true' if the record is the expected outgoing frame
+    bool _IsExpectedRecord(const can_capture_record_t &record);
+};
+
+#endif // __linux__
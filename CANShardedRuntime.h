@@ -0,0 +1,350 @@
+#pragma once
+
+// Host-side runtime serving several CAN buses: one CANManager per bus, each processed by its own thread.
+#if defined(__linux__)
+
+#include <stdint.h>
+#include <string.h>
+#include <new>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <pthread.h>
+#include <sched.h>
+#include "CAN_common.h"
+#include "CANManager.h"
+#include "CANConcurrentManager.h"
+
+#define CAN_SHARD_NO_CPU -1
+#define CAN_SHARD_NONE UINT8_MAX
+
+enum can_shard_message_type_t : uint8_t
+{
+    CAN_SHARD_MESSAGE_SEND = 0x00,    // the frame is sent to the bus of the destination shard
+    CAN_SHARD_MESSAGE_RECEIVE = 0x01, // the frame is processed as incoming frame of the destination shard
+};
+
+// Frame passed between shards
+struct can_shard_message_t
+{
+    can_shard_message_type_t type;
+    can_object_id_t object_id;
+    uint8_t raw_data[CAN_FRAME_MAX_PAYLOAD + 1];
+    uint8_t raw_data_length;
+};
+
+// Statistics of the shard or aggregated statistics of all shards
+struct can_shard_stats_t
+{
+    uint64_t process_count = 0;           // the number of Process() calls
+    uint32_t rx_dropped = 0;              // incoming frames rejected by the full queue
+    uint32_t tx_dropped = 0;              // outgoing frames rejected by the full queues
+    uint32_t channel_messages = 0;        // messages received from other shards
+    uint32_t channel_dropped = 0;         // messages to other shards rejected by the full channels
+    uint32_t frames_in_buffer = 0;        // incoming frames waiting in CANManager buffers
+};
+
+/******************************************************************************************
+ ******************************************************************************************/
+/// @brief CANShardedRuntime owns several shards: every shard is CANManager of one CAN bus wrapped by CANConcurrentManager
+///        (own incoming & outgoing queues) and processed by its own thread, optionally pinned to a CPU core.
+///        Shards don't share any state, so throughput grows with the number of buses.
+///        Shards exchange frames through lock-free single-producer single-consumer channels (one per pair of shards).
+/// @tparam _max_shards — The maximum number of shards
+/// @tparam _channel_size — The number of messages in every channel between shards, power of 2
+/// @tparam _rx_queue_size — The number of incoming frames in the queue of every shard, power of 2
+/// @tparam _max_tx_threads — The maximum number of threads which send frames to every shard
+/// @tparam _tx_queue_size — The number of outgoing frames in the queue of every sending thread, power of 2
+template <uint8_t _max_shards = 4, uint16_t _channel_size = 64,
+          uint16_t _rx_queue_size = 256, uint8_t _max_tx_threads = 4, uint16_t _tx_queue_size = 32>
+class CANShardedRuntime
+{
+    static_assert(_max_shards > 0 && _max_shards < CAN_SHARD_NONE);
+    static_assert(_channel_size > 0 && (_channel_size & (_channel_size - 1)) == 0);
+public:
+    using shard_manager_t = CANConcurrentManager<_rx_queue_size, _max_tx_threads, _tx_queue_size>;
+
+    /// @brief Creates CANShardedRuntime
+    /// @param time_func Function returning current time in milliseconds. nullptr to use the monotonic clock of the host.
+    CANShardedRuntime(can_time_function_t time_func = nullptr)
+        : _time_func(time_func){};
+
+    ~CANShardedRuntime()
+    {
+        Stop();
+        for (uint8_t i = 0; i < _shards_count; i++)
+            _GetShardManager(i).~shard_manager_t();
+    };
+
+    CANShardedRuntime(const CANShardedRuntime &) = delete;
+    CANShardedRuntime &operator=(const CANShardedRuntime &) = delete;
+
+    /// @brief Adds shard. Shards can't be added while the runtime is running.
+    /// @param can_manager Configured CANManager of the CAN bus. It should not be used directly after that.
+    /// @param cpu CPU core for the processing thread of the shard or CAN_SHARD_NO_CPU
+    /// @return Index of the shard or CAN_SHARD_NONE if the shard can't be added
+    uint8_t AddShard(CANManagerInterface &can_manager, int cpu = CAN_SHARD_NO_CPU)
+    {
+        if (_is_running.load() || _shards_count >= _max_shards)
+            return CAN_SHARD_NONE;
+
+        shard_t &shard = _shards[_shards_count];
+        new (shard.manager_storage) shard_manager_t(can_manager);
+        shard.cpu = cpu;
+
+        return _shards_count++;
+    }
+
+    /// @brief Returns the number of shards
+    /// @return The number of shards
+    uint8_t GetShardsCount()
+    {
+        return _shards_count;
+    }
+
+    /// @brief Returns the shard. Its IncomingCANFrame(), SendCustomFrame() & SendRawFrame() can be called from any thread.
+    /// @param shard_idx Index of the shard
+    /// @return Pointer to the shard or nullptr if it doesn't exist
+    shard_manager_t *GetShard(uint8_t shard_idx)
+    {
+        if (shard_idx >= _shards_count)
+            return nullptr;
+
+        return &_GetShardManager(shard_idx);
+    }
+
+    /// @brief Starts processing threads of all shards
+    /// @param process_interval_us Period of Process() calls in microseconds
+    /// @return 'true' if the threads were started, 'false' if the runtime is already running
+    bool Start(uint32_t process_interval_us = 1000)
+    {
+        if (_is_running.exchange(true))
+            return false;
+
+        _stop_requested.store(false);
+        _start_time = std::chrono::steady_clock::now();
+        for (uint8_t i = 0; i < _shards_count; i++)
+        {
+            _shards[i].thread = std::thread(&CANShardedRuntime::_ShardLoop, this, i, process_interval_us);
+            if (_shards[i].cpu != CAN_SHARD_NO_CPU)
+            {
+                cpu_set_t cpu_set;
+                CPU_ZERO(&cpu_set);
+                CPU_SET(_shards[i].cpu, &cpu_set);
+                // the affinity is a hint: the shard works on any core if the CPU isn't available
+                pthread_setaffinity_np(_shards[i].thread.native_handle(), sizeof(cpu_set), &cpu_set);
+            }
+        }
+
+        return true;
+    }
+
+    /// @brief Stops processing threads and waits for them
+    void Stop()
+    {
+        if (!_is_running.load())
+            return;
+
+        _stop_requested.store(true);
+        for (uint8_t i = 0; i < _shards_count; i++)
+        {
+            if (_shards[i].thread.joinable())
+                _shards[i].thread.join();
+        }
+        _is_running.store(false);
+    }
+
+    /// @brief Checks if the processing threads are running
+    /// @return 'true' if the runtime is running
+    bool IsRunning()
+    {
+        return _is_running.load();
+    }
+
+    /// @brief Returns index of the shard processed by the current thread. Handlers and sending functions of shards
+    ///        can use it to find their shard.
+    /// @return Index of the shard or CAN_SHARD_NONE if it isn't a processing thread
+    static uint8_t GetCurrentShardIndex()
+    {
+        return _current_shard_idx;
+    }
+
+    /// @brief Passes the frame to another shard. It can be called from the processing thread of the shard only
+    ///        (e.g. from handlers or sending function), other threads should use the shard's methods.
+    /// @param dst_shard_idx Index of the destination shard
+    /// @param type Send the frame to the destination bus or process it as incoming frame of the destination shard
+    /// @param id CAN frame ID
+    /// @param data Frame data including function ID
+    /// @param length Frame data length including function ID
+    /// @return 'true' if the frame was passed to the channel
+    bool SendToShard(uint8_t dst_shard_idx, can_shard_message_type_t type, can_object_id_t id, const uint8_t *data, uint8_t length)
+    {
+        uint8_t src_shard_idx = _current_shard_idx;
+        if (src_shard_idx >= _shards_count || dst_shard_idx >= _shards_count || src_shard_idx == dst_shard_idx ||
+            data == nullptr || length == 0 || length > CAN_FRAME_MAX_PAYLOAD + 1)
+            return false;
+
+        channel_t &channel = _channels[src_shard_idx][dst_shard_idx];
+        uint32_t head = channel.head.load(std::memory_order_relaxed);
+        if (head - channel.tail.load(std::memory_order_acquire) >= _channel_size)
+        {
+            _shards[src_shard_idx].channel_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        can_shard_message_t &message = channel.messages[head & (_channel_size - 1)];
+        message.type = type;
+        message.object_id = id;
+        memcpy(message.raw_data, data, length);
+        message.raw_data_length = length;
+        channel.head.store(head + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /// @brief Returns statistics of the shard
+    /// @param shard_idx Index of the shard
+    /// @param stats [OUT] Statistics of the shard
+    /// @return 'true' if the shard exists
+    bool GetShardStats(uint8_t shard_idx, can_shard_stats_t &stats)
+    {
+        if (shard_idx >= _shards_count)
+            return false;
+
+        shard_t &shard = _shards[shard_idx];
+        shard_manager_t &shard_manager = _GetShardManager(shard_idx);
+        stats = {};
+        stats.process_count = shard.process_count.load(std::memory_order_relaxed);
+        stats.rx_dropped = shard_manager.GetNumOfDroppedIncomingFrames();
+        stats.tx_dropped = shard_manager.GetNumOfDroppedOutgoingFrames();
+        stats.channel_messages = shard.channel_messages.load(std::memory_order_relaxed);
+        stats.channel_dropped = shard.channel_dropped.load(std::memory_order_relaxed);
+        stats.frames_in_buffer = shard.frames_in_buffer.load(std::memory_order_relaxed);
+
+        return true;
+    }
+
+    /// @brief Returns statistics of all shards summed up
+    /// @param stats [OUT] Aggregated statistics
+    void GetStats(can_shard_stats_t &stats)
+    {
+        stats = {};
+        for (uint8_t i = 0; i < _shards_count; i++)
+        {
+            can_shard_stats_t shard_stats;
+            GetShardStats(i, shard_stats);
+            stats.process_count += shard_stats.process_count;
+            stats.rx_dropped += shard_stats.rx_dropped;
+            stats.tx_dropped += shard_stats.tx_dropped;
+            stats.channel_messages += shard_stats.channel_messages;
+            stats.channel_dropped += shard_stats.channel_dropped;
+            stats.frames_in_buffer += shard_stats.frames_in_buffer;
+        }
+    }
+
+private:
+    struct alignas(CAN_CONCURRENT_CACHE_LINE_SIZE) shard_t
+    {
+        alignas(shard_manager_t) uint8_t manager_storage[sizeof(shard_manager_t)];
+        int cpu = CAN_SHARD_NO_CPU;
+        std::thread thread;
+
+        // statistics: written by the processing thread of the shard
+        std::atomic<uint64_t> process_count{0};
+        std::atomic<uint32_t> channel_messages{0};
+        std::atomic<uint32_t> channel_dropped{0};
+        std::atomic<uint32_t> frames_in_buffer{0};
+    };
+
+    // single-producer single-consumer channel between two shards
+    struct channel_t
+    {
+        alignas(CAN_CONCURRENT_CACHE_LINE_SIZE) std::atomic<uint32_t> head{0}; // written by the source shard
+        alignas(CAN_CONCURRENT_CACHE_LINE_SIZE) std::atomic<uint32_t> tail{0}; // written by the destination shard
+        can_shard_message_t messages[_channel_size];
+    };
+
+    shard_t _shards[_max_shards];
+    uint8_t _shards_count = 0;
+
+    channel_t _channels[_max_shards][_max_shards]; // source shard → destination shard
+
+    can_time_function_t _time_func = nullptr;
+    std::chrono::steady_clock::time_point _start_time;
+    std::atomic<bool> _is_running{false};
+    std::atomic<bool> _stop_requested{false};
+
+    static thread_local uint8_t _current_shard_idx;
+
+    shard_manager_t &_GetShardManager(uint8_t shard_idx)
+    {
+        return *reinterpret_cast<shard_manager_t *>(_shards[shard_idx].manager_storage);
+    }
+
+    /// @brief Returns current time for Process() calls
+    /// @return Time in milliseconds
+    uint32_t _GetTime()
+    {
+        if (_time_func != nullptr)
+            return _time_func();
+
+        return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - _start_time).count();
+    }
+
+    /// @brief Passes messages of other shards to the CANManager of the shard. It is called by the processing thread of the shard.
+    /// @param shard_idx Index of the shard
+    void _ReceiveChannelMessages(uint8_t shard_idx)
+    {
+        CANManagerInterface &can_manager = _GetShardManager(shard_idx).GetManager();
+        uint32_t received = 0;
+        for (uint8_t src_shard_idx = 0; src_shard_idx < _shards_count; src_shard_idx++)
+        {
+            channel_t &channel = _channels[src_shard_idx][shard_idx];
+            uint32_t tail = channel.tail.load(std::memory_order_relaxed);
+            uint32_t head = channel.head.load(std::memory_order_acquire);
+            for (; tail != head; tail++)
+            {
+                can_shard_message_t &message = channel.messages[tail & (_channel_size - 1)];
+                if (message.type == CAN_SHARD_MESSAGE_RECEIVE)
+                    can_manager.IncomingCANFrame(message.object_id, message.raw_data, message.raw_data_length);
+                else
+                    can_manager.SendRawFrame(message.object_id, message.raw_data, message.raw_data_length);
+                received++;
+            }
+            channel.tail.store(tail, std::memory_order_release);
+        }
+
+        if (received > 0)
+            _shards[shard_idx].channel_messages.fetch_add(received, std::memory_order_relaxed);
+    }
+
+    /// @brief Processing loop of the shard
+    /// @param shard_idx Index of the shard
+    /// @param process_interval_us Period of Process() calls in microseconds
+    void _ShardLoop(uint8_t shard_idx, uint32_t process_interval_us)
+    {
+        _current_shard_idx = shard_idx;
+        shard_t &shard = _shards[shard_idx];
+        shard_manager_t &shard_manager = _GetShardManager(shard_idx);
+
+        auto next_wakeup = std::chrono::steady_clock::now();
+        while (!_stop_requested.load(std::memory_order_relaxed))
+        {
+            _ReceiveChannelMessages(shard_idx);
+            shard_manager.Process(_GetTime());
+
+            shard.process_count.fetch_add(1, std::memory_order_relaxed);
+            shard.frames_in_buffer.store(shard_manager.GetManager().GetNumOfFramesInBuffer(), std::memory_order_relaxed);
+
+            next_wakeup += std::chrono::microseconds(process_interval_us);
+            std::this_thread::sleep_until(next_wakeup);
+        }
+
+        _current_shard_idx = CAN_SHARD_NONE;
+    }
+};
+
+template <uint8_t _max_shards, uint16_t _channel_size, uint16_t _rx_queue_size, uint8_t _max_tx_threads, uint16_t _tx_queue_size>
+thread_local uint8_t CANShardedRuntime<_max_shards, _channel_size, _rx_queue_size, _max_tx_threads, _tx_queue_size>::_current_shard_idx = CAN_SHARD_NONE;
+
+#endif // __linux__
@@ -0,0 +1,273 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include "CAN_common.h"
+#include "CANObject.h"
+
+/******************************************************************************************
+ ******************************************************************************************/
+/// @brief CANSignal describes one signal of the packed payload: bit position, width, signedness and scaling.
+///        Bits are numbered in little-endian order: bit 0 is the lowest bit of the first data byte.
+///        Physical value = raw value * _factor_num / _factor_den + _offset.
+///        Packing code is generated at compile time: shifts, masks and the number of touched bytes are constants.
+/// @tparam _start_bit — The lowest bit of the signal in the payload
+/// @tparam _bit_length — The width of the signal in bits (up to 31 bits for unsigned and 32 bits for signed signals)
+/// @tparam _is_signed — 'true' if the signal is two's complement signed value
+/// @tparam _factor_num — Numerator of the scale factor
+/// @tparam _factor_den — Denominator of the scale factor
+/// @tparam _offset — Offset of the physical value
+template <uint8_t _start_bit, uint8_t _bit_length, bool _is_signed = false,
+          int32_t _factor_num = 1, int32_t _factor_den = 1, int32_t _offset = 0>
+struct CANSignal
+{
+    static_assert(_bit_length > 0 && _bit_length <= (_is_signed ? 32 : 31)); // raw values are int32_t
+    static_assert(_start_bit + _bit_length <= 64);                           // layout masks are 64-bit wide
+    static_assert(_factor_num != 0 && _factor_den > 0);
+
+    static constexpr uint8_t start_bit = _start_bit;
+    static constexpr uint8_t bit_length = _bit_length;
+    static constexpr uint8_t end_bit = _start_bit + _bit_length; // the first bit after the signal
+    static constexpr uint8_t first_byte = _start_bit / 8;
+    static constexpr uint8_t last_byte = (end_bit - 1) / 8;
+    static constexpr uint64_t value_mask = ((uint64_t)1 << _bit_length) - 1;
+    static constexpr uint64_t layout_mask = value_mask << _start_bit; // bits of the signal in the payload
+    static constexpr int32_t raw_min = _is_signed ? (int32_t)(-(int64_t)((uint64_t)1 << (_bit_length - 1))) : 0;
+    static constexpr int32_t raw_max = _is_signed ? (int32_t)(((uint64_t)1 << (_bit_length - 1)) - 1) : (int32_t)value_mask;
+
+    /// @brief Writes the raw value into the payload. Values out of range are saturated. Other bits are kept.
+    /// @param payload Payload bytes
+    /// @param raw Raw value of the signal
+    static inline void Pack(uint8_t *payload, int32_t raw)
+    {
+        if (raw < raw_min)
+            raw = raw_min;
+        if (raw > raw_max)
+            raw = raw_max;
+
+        const uint64_t field = ((uint64_t)(uint32_t)raw & value_mask) << (_start_bit % 8);
+        const uint64_t field_mask = value_mask << (_start_bit % 8);
+        for (uint8_t i = 0; i <= last_byte - first_byte; i++)
+        {
+            const uint8_t byte_mask = (uint8_t)(field_mask >> (8 * i));
+            payload[first_byte + i] = (payload[first_byte + i] & ~byte_mask) | ((uint8_t)(field >> (8 * i)) & byte_mask);
+        }
+    }
+
+    /// @brief Reads the raw value from the payload
+    /// @param payload Payload bytes
+    /// @return Raw value of the signal (sign extended for signed signals)
+    static inline int32_t Unpack(const uint8_t *payload)
+    {
+        uint64_t field = 0;
+        for (uint8_t i = 0; i <= last_byte - first_byte; i++)
+            field |= (uint64_t)payload[first_byte + i] << (8 * i);
+
+        uint32_t raw = (uint32_t)((field >> (_start_bit % 8)) & value_mask);
+        if (_is_signed && _bit_length < 32 && (raw & ((uint32_t)1 << (_bit_length - 1))))
+            raw |= ~(uint32_t)value_mask;
+
+        return (int32_t)raw;
+    }
+
+    /// @brief Converts the raw value to the physical one
+    /// @param raw Raw value of the signal
+    /// @return Physical value
+    static inline float ToPhysical(int32_t raw)
+    {
+        return (float)raw * _factor_num / _factor_den + _offset;
+    }
+
+    /// @brief Converts the physical value to the raw one (rounded to the nearest and saturated)
+    /// @param value Physical value
+    /// @return Raw value of the signal
+    static inline int32_t FromPhysical(float value)
+    {
+        float raw = (value - _offset) * _factor_den / _factor_num;
+        if (raw <= (float)raw_min)
+            return raw_min;
+        if (raw >= (float)raw_max)
+            return raw_max;
+
+        return (int32_t)(raw < 0 ? raw - 0.5f : raw + 0.5f);
+    }
+};
+
+/// @brief Selects the signal type by index
+template <uint8_t _index, typename... _signals>
+struct can_signal_at;
+
+template <typename _signal, typename... _rest>
+struct can_signal_at<0, _signal, _rest...>
+{
+    using type = _signal;
+};
+
+template <uint8_t _index, typename _signal, typename... _rest>
+struct can_signal_at<_index, _signal, _rest...>
+{
+    using type = typename can_signal_at<_index - 1, _rest...>::type;
+};
+
+/// @brief Returns the payload size of the signals in bytes
+template <typename... _signals>
+constexpr uint8_t can_signals_bytes()
+{
+    constexpr uint8_t end_bits[] = {_signals::end_bit...};
+    uint8_t max_end_bit = 0;
+    for (uint8_t end_bit : end_bits)
+    {
+        if (end_bit > max_end_bit)
+            max_end_bit = end_bit;
+    }
+    return (max_end_bit + 7) / 8;
+}
+
+/// @brief Checks whether the signals overlap
+template <typename... _signals>
+constexpr bool can_signals_overlap()
+{
+    constexpr uint64_t layout_masks[] = {_signals::layout_mask...};
+    uint64_t used_bits = 0;
+    for (uint64_t layout_mask : layout_masks)
+    {
+        if (used_bits & layout_mask)
+            return true;
+        used_bits |= layout_mask;
+    }
+    return false;
+}
+
+/******************************************************************************************
+ ******************************************************************************************/
+/// @brief CANSignalObject is CANObject with the payload of bit-packed signals of different widths and types.
+///        Data fields of the base CANObject<uint8_t, N> are the bytes of the packed payload, so timer, event and request
+///        frames carry all signals at once. The timer type of every byte is the highest one among the signals
+///        which touch the byte, so the object reports the worst state of its signals.
+///        Incoming frames (e.g. in SET handlers or on mirrors) are decoded with DecodeSignal().
+/// @tparam _signals — CANSignal types in the order of their indexes
+template <typename... _signals>
+class CANSignalObject : public CANObject<uint8_t, can_signals_bytes<_signals...>()>
+{
+    static_assert(sizeof...(_signals) > 0);                                    // at least one signal is needed
+    static_assert(can_signals_bytes<_signals...>() <= CAN_FRAME_MAX_PAYLOAD);  // signals must fit into one frame
+    static_assert(!can_signals_overlap<_signals...>());                         // signals must not share bits
+
+    using base_t = CANObject<uint8_t, can_signals_bytes<_signals...>()>;
+    static constexpr uint8_t _signals_count = sizeof...(_signals);
+    static constexpr uint8_t _payload_size = can_signals_bytes<_signals...>();
+
+public:
+    /// @brief Constructor of the CANSignalObject. Parameters are the same as CANObject ones.
+    CANSignalObject(can_object_id_t id,
+                    uint16_t timer_period_ms = CAN_TIMER_DISABLED, uint16_t error_period_ms = CAN_ERROR_DISABLED,
+                    bool flood_mode = false, object_type_t object_type = CAN_OBJECT_TYPE_ORDINARY)
+        : base_t(id, timer_period_ms, error_period_ms, flood_mode, object_type){};
+
+    virtual ~CANSignalObject() = default;
+
+    /// @brief Sets raw value of the signal
+    /// @tparam _index — Index of the signal
+    /// @param raw Raw value. Values out of the signal range are saturated.
+    /// @param timer_type The type of value for timer
+    /// @param event_type The type of value for event
+    template <uint8_t _index>
+    void SetSignal(int32_t raw, timer_type_t timer_type = CAN_TIMER_TYPE_NONE, event_type_t event_type = CAN_EVENT_TYPE_NONE)
+    {
+        static_assert(_index < _signals_count);
+        using signal_t = typename can_signal_at<_index, _signals...>::type;
+
+        uint8_t payload[_payload_size];
+        memcpy(payload, base_t::GetValuePtr(0), _payload_size);
+        signal_t::Pack(payload, raw);
+
+        _signal_states[_index] = timer_type | (event_type == CAN_EVENT_TYPE_ERROR ? CAN_EVENT_TYPE_ERROR : CAN_EVENT_TYPE_NONE);
+        for (uint8_t byte = signal_t::first_byte; byte <= signal_t::last_byte; byte++)
+        {
+            // the pending NORMAL event of the byte (set by another signal) is kept until the event frame is sent
+            uint8_t byte_state = _GetByteState(byte);
+            uint8_t byte_event = byte_state & CAN_EVENT_TYPE_MASK;
+            if (byte_event != CAN_EVENT_TYPE_ERROR &&
+                (event_type == CAN_EVENT_TYPE_NORMAL || (base_t::_GetDataFieldState(byte) & CAN_EVENT_TYPE_MASK) == CAN_EVENT_TYPE_NORMAL))
+                byte_event = CAN_EVENT_TYPE_NORMAL;
+
+            base_t::SetValue(byte, payload[byte], (timer_type_t)(byte_state & CAN_TIMER_TYPE_MASK), (event_type_t)byte_event);
+        }
+    }
+
+    /// @brief Returns raw value of the signal
+    /// @tparam _index — Index of the signal
+    /// @return Raw value
+    template <uint8_t _index>
+    int32_t GetSignal()
+    {
+        return DecodeSignal<_index>((const uint8_t *)base_t::GetValuePtr(0));
+    }
+
+    /// @brief Sets physical value of the signal
+    /// @tparam _index — Index of the signal
+    /// @param value Physical value. It is scaled, rounded and saturated to the signal range.
+    /// @param timer_type The type of value for timer
+    /// @param event_type The type of value for event
+    template <uint8_t _index>
+    void SetSignalPhysical(float value, timer_type_t timer_type = CAN_TIMER_TYPE_NONE, event_type_t event_type = CAN_EVENT_TYPE_NONE)
+    {
+        static_assert(_index < _signals_count);
+        SetSignal<_index>(can_signal_at<_index, _signals...>::type::FromPhysical(value), timer_type, event_type);
+    }
+
+    /// @brief Returns physical value of the signal
+    /// @tparam _index — Index of the signal
+    /// @return Physical value
+    template <uint8_t _index>
+    float GetSignalPhysical()
+    {
+        static_assert(_index < _signals_count);
+        return can_signal_at<_index, _signals...>::type::ToPhysical(GetSignal<_index>());
+    }
+
+    /// @brief Decodes raw value of the signal from the payload (e.g. data of the incoming frame)
+    /// @tparam _index — Index of the signal
+    /// @param payload Payload bytes (without function ID)
+    /// @return Raw value
+    template <uint8_t _index>
+    static int32_t DecodeSignal(const uint8_t *payload)
+    {
+        static_assert(_index < _signals_count);
+        return can_signal_at<_index, _signals...>::type::Unpack(payload);
+    }
+
+    /// @brief Returns the number of signals
+    /// @return The number of signals
+    static constexpr uint8_t GetSignalsCount()
+    {
+        return _signals_count;
+    }
+
+private:
+    // timer type and ERROR event of every signal
+    uint8_t _signal_states[_signals_count] = {0};
+
+    /// @brief Returns the highest timer type and ERROR event among the signals which touch the byte
+    /// @param byte Index of the payload byte
+    /// @return The state of the byte
+    uint8_t _GetByteState(uint8_t byte)
+    {
+        static constexpr uint8_t first_bytes[] = {_signals::first_byte...};
+        static constexpr uint8_t last_bytes[] = {_signals::last_byte...};
+
+        uint8_t timer_type = CAN_TIMER_TYPE_NONE;
+        uint8_t event_type = CAN_EVENT_TYPE_NONE;
+        for (uint8_t i = 0; i < _signals_count; i++)
+        {
+            if (byte < first_bytes[i] || byte > last_bytes[i])
+                continue;
+
+            if ((_signal_states[i] & CAN_TIMER_TYPE_MASK) > timer_type)
+                timer_type = _signal_states[i] & CAN_TIMER_TYPE_MASK;
+            if ((_signal_states[i] & CAN_EVENT_TYPE_MASK) == CAN_EVENT_TYPE_ERROR)
+                event_type = CAN_EVENT_TYPE_ERROR;
+        }
+        return timer_type | event_type;
+    }
+};
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <stdint.h>
+#include "CAN_common.h"
+
+#ifndef CAN_TX_DEFERRED_QUEUE_SIZE
+#define CAN_TX_DEFERRED_QUEUE_SIZE 4 // the number of frames CANManager keeps while its TX budget is exhausted
+#endif
+
+// Traffic classes of outgoing frames with separate budgets
+enum can_tx_class_t : uint8_t
+{
+    CAN_TX_CLASS_TIMER = 0x00,    // timer frames
+    CAN_TX_CLASS_EVENT = 0x01,    // normal event frames
+    CAN_TX_CLASS_ERROR = 0x02,    // error event frames
+    CAN_TX_CLASS_RESPONSE = 0x03, // answers to incoming frames (including error answers)
+
+    CAN_TX_CLASS_COUNT = 0x04,
+    CAN_TX_CLASS_UNLIMITED = 0xFF, // frames which are never limited (real-time data, custom & raw frames)
+};
+
+// What happens with the frame when the budget of its class is exhausted
+enum can_tx_budget_policy_t : uint8_t
+{
+    CAN_TX_BUDGET_POLICY_DEFER = 0x00, // the frame waits for the next token
+    CAN_TX_BUDGET_POLICY_DROP = 0x01,  // the frame is dropped
+};
+
+// Statistics of one traffic class of the budget
+struct can_tx_budget_stats_t
+{
+    uint32_t frames_passed = 0;   // the number of frames which got the token
+    uint32_t frames_deferred = 0; // the number of times frames were postponed because of the empty bucket
+    uint32_t frames_dropped = 0;  // the number of frames dropped because of the empty bucket (or the full deferred queue)
+};
+
+/******************************************************************************************
+ ******************************************************************************************/
+/// @brief CANTxBudget limits outgoing traffic with token buckets: one bucket per traffic class.
+///        Every bucket is refilled with the configured rate (frames per second) up to the burst size,
+///        every frame takes one token. So the class never sends more than 'burst + rate * t' frames during time t.
+///        The budget may be attached to CANObject (limits the object) and to CANManager (limits the whole node).
+///        Tokens are counted in thousandths of frame with integer math only.
+class CANTxBudget
+{
+public:
+    /// @brief Creates the budget without limits
+    /// @param policy What happens with the frames over the budget
+    CANTxBudget(can_tx_budget_policy_t policy = CAN_TX_BUDGET_POLICY_DEFER)
+        : _policy(policy){};
+
+    /// @brief Sets the limit of the traffic class. The bucket becomes full.
+    /// @param tx_class Traffic class
+    /// @param frames_per_second Refill rate of the bucket. 0 disables the limit.
+    /// @param burst The maximum number of frames which can be sent at once (size of the bucket), at least 1
+    void SetLimit(can_tx_class_t tx_class, uint16_t frames_per_second, uint16_t burst)
+    {
+        if (tx_class >= CAN_TX_CLASS_COUNT)
+            return;
+
+        bucket_t &bucket = _buckets[tx_class];
+        bucket.rate = frames_per_second;
+        bucket.capacity = (uint32_t)(burst > 0 ? burst : 1) * _token_size;
+        bucket.tokens = bucket.capacity;
+        bucket.started = false;
+    }
+
+    /// @brief Sets the policy for the frames over the budget
+    /// @param policy The policy
+    void SetPolicy(can_tx_budget_policy_t policy)
+    {
+        _policy = policy;
+    }
+
+    /// @brief Returns the policy for the frames over the budget
+    /// @return The policy
+    can_tx_budget_policy_t GetPolicy()
+    {
+        return _policy;
+    }
+
+    /// @brief Checks whether the frame of the traffic class can be sent now
+    /// @param tx_class Traffic class
+    /// @param time Current time
+    /// @return 'true' if the bucket has a token or the class isn't limited
+    bool HasToken(can_tx_class_t tx_class, uint32_t time)
+    {
+        if (tx_class >= CAN_TX_CLASS_COUNT || _buckets[tx_class].rate == 0)
+            return true;
+
+        _Refill(_buckets[tx_class], time);
+        return _buckets[tx_class].tokens >= _token_size;
+    }
+
+    /// @brief Takes the token for the frame of the traffic class
+    /// @param tx_class Traffic class
+    /// @param time Current time
+    /// @return 'true' if the token was taken or the class isn't limited, 'false' if the bucket is empty
+    bool TakeToken(can_tx_class_t tx_class, uint32_t time)
+    {
+        if (tx_class >= CAN_TX_CLASS_COUNT)
+            return true;
+
+        if (!HasToken(tx_class, time))
+            return false;
+
+        if (_buckets[tx_class].rate > 0)
+            _buckets[tx_class].tokens -= _token_size;
+        _stats[tx_class].frames_passed++;
+        return true;
+    }
+
+    /// @brief Counts the frame which was postponed because of the empty bucket
+    /// @param tx_class Traffic class
+    void CountDeferred(can_tx_class_t tx_class)
+    {
+        if (tx_class < CAN_TX_CLASS_COUNT)
+            _stats[tx_class].frames_deferred++;
+    }
+
+    /// @brief Counts the frame which was dropped because of the empty bucket
+    /// @param tx_class Traffic class
+    void CountDropped(can_tx_class_t tx_class)
+    {
+        if (tx_class < CAN_TX_CLASS_COUNT)
+            _stats[tx_class].frames_dropped++;
+    }
+
+    /// @brief Returns statistics of the traffic class
+    /// @param tx_class Traffic class
+    /// @param stats [OUT] Statistics
+    /// @return 'true' if the traffic class is correct
+    bool GetStats(can_tx_class_t tx_class, can_tx_budget_stats_t &stats)
+    {
+        if (tx_class >= CAN_TX_CLASS_COUNT)
+            return false;
+
+        stats = _stats[tx_class];
+        return true;
+    }
+
+    /// @brief Resets statistics of all traffic classes
+    void ResetStats()
+    {
+        for (uint8_t i = 0; i < CAN_TX_CLASS_COUNT; i++)
+        {
+            _stats[i] = {};
+        }
+    }
+
+private:
+    static constexpr uint32_t _token_size = 1000; // one frame in thousandths: refill is 'rate' thousandths per ms
+
+    struct bucket_t
+    {
+        uint16_t rate = 0; // frames per second, 0 means no limit
+        bool started = false;
+        uint32_t capacity = 0;
+        uint32_t tokens = 0;
+        uint32_t last_time = 0;
+    };
+
+    bucket_t _buckets[CAN_TX_CLASS_COUNT] = {};
+    can_tx_budget_stats_t _stats[CAN_TX_CLASS_COUNT] = {};
+    can_tx_budget_policy_t _policy = CAN_TX_BUDGET_POLICY_DEFER;
+
+    /// @brief Adds tokens for the time passed since the last refill
+    /// @param bucket The bucket
+    /// @param time Current time
+    static void _Refill(bucket_t &bucket, uint32_t time)
+    {
+        if (!bucket.started)
+        {
+            bucket.started = true;
+            bucket.last_time = time;
+            return;
+        }
+
+        uint32_t elapsed = time - bucket.last_time;
+        if (elapsed == 0 || (int32_t)elapsed < 0)
+            return;
+
+        bucket.last_time = time;
+        if (elapsed > UINT16_MAX)
+            elapsed = UINT16_MAX; // any bucket is full after 65 s; keeps 'elapsed * rate' in 32 bits
+
+        uint32_t tokens = bucket.tokens + elapsed * bucket.rate;
+        bucket.tokens = (tokens > bucket.capacity || tokens < bucket.tokens) ? bucket.capacity : tokens;
+    }
+};
@@ -11,6 +11,7 @@ void clear_can_frame_struct(can_frame_t &can_frame)
     can_frame.raw_data_length = 0;
     can_frame.initialized = false;
     can_frame.time_ms = 0;
+    can_frame.flags = CAN_FRAME_FLAG_NONE;
 }
 
 /// @brief Copies data from one CAN frame to another
@@ -23,6 +24,7 @@ void copy_can_frame_struct(can_frame_t &dest_can_frame, can_frame_t src_can_fram
     dest_can_frame.time_ms = src_can_frame.time_ms;
     dest_can_frame.object_id = src_can_frame.object_id;
     dest_can_frame.raw_data_length = src_can_frame.raw_data_length;
+    dest_can_frame.flags = src_can_frame.flags;
 }
 
 /// @brief Clears all attributes of CAN error structure
@@ -47,10 +49,13 @@ void set_block_info_params(CANObjectInterface &block_sys_object)
     block_sys_object.SetTimerPeriod(15000);
     block_sys_object.SetErrorEventDelay(CAN_ERROR_DISABLED);
     block_sys_object.SetObjectType(CAN_OBJECT_TYPE_SYSTEM_BLOCK_INFO);
+#if CAN_OBJECT_LEGACY_HANDLERS
     block_sys_object.RegisterFunctionEvent(nullptr);
     block_sys_object.RegisterFunctionRequest(nullptr);
     block_sys_object.RegisterFunctionSet(nullptr);
     block_sys_object.RegisterFunctionTimer(nullptr);
+#endif
+    block_sys_object.SetHandlerTable(nullptr);
 }
 
 /// @brief Common BlockHealth parameters will be applied to the specified CANObject.
@@ -65,10 +70,13 @@ void set_block_health_params(CANObjectInterface &block_sys_object)
     block_sys_object.SetTimerPeriod(CAN_TIMER_DISABLED);
     block_sys_object.SetErrorEventDelay(300);
     block_sys_object.SetObjectType(CAN_OBJECT_TYPE_SYSTEM_BLOCK_HEALTH);
+#if CAN_OBJECT_LEGACY_HANDLERS
     block_sys_object.RegisterFunctionEvent(nullptr);
     block_sys_object.RegisterFunctionRequest(nullptr);
     block_sys_object.RegisterFunctionSet(nullptr);
     block_sys_object.RegisterFunctionTimer(nullptr);
+#endif
+    block_sys_object.SetHandlerTable(nullptr);
 };
 
 /// @brief Common BlockFeatures parameters will be applied to the specified CANObject.
@@ -84,10 +92,13 @@ void set_block_features_params(CANObjectInterface &block_sys_object)
     block_sys_object.SetTimerPeriod(15000);
     block_sys_object.SetErrorEventDelay(CAN_ERROR_DISABLED);
     block_sys_object.SetObjectType(CAN_OBJECT_TYPE_SYSTEM_BLOCK_FEATURES);
+#if CAN_OBJECT_LEGACY_HANDLERS
     block_sys_object.RegisterFunctionEvent(nullptr);
     block_sys_object.RegisterFunctionRequest(nullptr);
     block_sys_object.RegisterFunctionSet(nullptr);
     block_sys_object.RegisterFunctionTimer(nullptr);
+#endif
+    block_sys_object.SetHandlerTable(nullptr);
 };
 
 /// @brief Common BlockError parameters will be applied to the specified CANObject.
@@ -102,10 +113,13 @@ void set_block_error_params(CANObjectInterface &block_sys_object)
     block_sys_object.SetTimerPeriod(CAN_TIMER_DISABLED);
     block_sys_object.SetErrorEventDelay(300);
     block_sys_object.SetObjectType(CAN_OBJECT_TYPE_SYSTEM_BLOCK_ERROR);
+#if CAN_OBJECT_LEGACY_HANDLERS
     block_sys_object.RegisterFunctionEvent(nullptr);
     block_sys_object.RegisterFunctionRequest(nullptr);
     block_sys_object.RegisterFunctionSet(nullptr);
     block_sys_object.RegisterFunctionTimer(nullptr);
+#endif
+    block_sys_object.SetHandlerTable(nullptr);
 };
 
 /// @brief Debug logger function: decodes function ID to to human-readable string.
@@ -276,6 +290,9 @@ const char *get_object_type_name(object_type_t object_type)
     case CAN_OBJECT_TYPE_SILENT:
         return "object type: silent listener";
 
+    case CAN_OBJECT_TYPE_SYSTEM_BLOCK_STATS:
+        return "object type: system object - BlockStats";
+
     case CAN_OBJECT_TYPE_UNKNOWN:
     default:
         return "object type: unknown";
@@ -306,6 +323,9 @@ const char *get_error_code_name_for_section(error_section_t error_section, uint8
         case ERROR_CODE_MANAGER_CAN_FRAME_AND_ERROR_STRUCT_ARE_BOTH_BLANK:
             return "error: section [CANManager], code [CAN frame and error structure are both blank after handlers]";
 
+        case ERROR_CODE_MANAGER_REMOTE_NODE_TIMEOUT:
+            return "error: section [CANManager], code [remote node timeout]";
+
         case ERROR_CODE_MANAGER_SOMETHING_WRONG:
             return "error: section [CANManager], code [something went wrong]";
 
@@ -3,9 +3,14 @@
 
 #include <stdint.h>
 
-#define CAN_FRAME_MAX_PAYLOAD 7 // excluding the function ID
+#ifndef CAN_FRAME_MAX_PAYLOAD
+#define CAN_FRAME_MAX_PAYLOAD 7 // excluding the function ID; up to 63 with CAN FD controllers (padded FD frames longer than this are rejected)
+#endif
+#define CAN_CLASSIC_FRAME_MAX_LENGTH 8 // longer frames are sent in CAN FD format
+#define CAN_FD_FRAME_MAX_LENGTH 64
 #define CAN_TIMER_DISABLED UINT16_MAX
 #define CAN_ERROR_DISABLED UINT16_MAX
+#define CAN_MAX_FRAMES_PER_TICK_DEFAULT 4 // every automatic function of CANObject can send its frame in the same tick
 
 // base CAN frame format uses 11-bit IDs (uint16)
 // extended CAN frame format uses 29-bit IDs (uint32)
@@ -66,8 +71,62 @@ enum can_function_id_t : uint8_t
     CAN_FUNC_FIRST_OUT_ERR = 0xC0,
 };
 
+static_assert(CAN_FRAME_MAX_PAYLOAD >= CAN_CLASSIC_FRAME_MAX_LENGTH - 1 && CAN_FRAME_MAX_PAYLOAD < CAN_FD_FRAME_MAX_LENGTH);
+
 using can_send_function_t = void (*)(can_object_id_t id, uint8_t *data, uint8_t length);
 
+// Format flags of CAN FD frames
+enum can_frame_flags_t : uint8_t
+{
+    CAN_FRAME_FLAG_NONE = 0x00,
+    CAN_FRAME_FLAG_FDF = 0x01, // CAN FD format (frames longer than 8 bytes always have it)
+    CAN_FRAME_FLAG_BRS = 0x02, // bit rate switch in the data phase (CAN FD frames only)
+};
+// sending function of CAN FD controllers: the driver pads the data up to can_dlc_to_length(can_length_to_dlc(length))
+using can_send_fd_function_t = void (*)(can_object_id_t id, uint8_t *data, uint8_t length, uint8_t flags);
+// tag of the CANManager constructor with the CAN FD sending function: CANManager<>(CAN_SEND_FD, func)
+struct can_send_fd_tag_t
+{
+};
+constexpr can_send_fd_tag_t CAN_SEND_FD = {};
+
+/// @brief Converts DLC of the frame to its data length: DLC 9..15 are CAN FD lengths 12..64
+/// @param dlc Data length code (4 bits)
+/// @return Data length in bytes
+inline uint8_t can_dlc_to_length(uint8_t dlc)
+{
+    static const uint8_t lengths[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64};
+    return lengths[dlc & 0x0F];
+}
+
+/// @brief Returns the smallest DLC which holds the data. CAN FD frames are padded up to the length of the DLC.
+/// @param length Data length in bytes (up to 64)
+/// @return Data length code
+inline uint8_t can_length_to_dlc(uint8_t length)
+{
+    if (length <= 8)
+        return length;
+    if (length <= 24)
+        return 9 + (length - 9) / 4; // 12, 16, 20, 24
+    if (length <= 32)
+        return 13;
+    if (length <= 48)
+        return 14;
+    return 15;
+}
+
+/// @brief Checks the length of the received frame. CAN FD frames longer than 8 bytes may be padded up to the length of their DLC.
+/// @param length Received data length (including function ID)
+/// @param expected_length Data length of the sent frame
+/// @return 'true' if the frame has the expected data
+inline bool can_is_frame_length_matched(uint8_t length, uint8_t expected_length)
+{
+    if (length <= CAN_CLASSIC_FRAME_MAX_LENGTH)
+        return length == expected_length;
+
+    return length >= expected_length && length <= can_dlc_to_length(can_length_to_dlc(expected_length));
+}
+
 // CANFrame data structure
 // It can be changed to class later (in case we need it)
 struct can_frame_t
@@ -85,7 +144,20 @@ struct can_frame_t
     uint8_t raw_data_length = 0;
     bool initialized = false;
     uint32_t time_ms = 0;
+    uint8_t flags = CAN_FRAME_FLAG_NONE; // can_frame_flags_t of outgoing frames (batched sending)
 };
+// batched sending: all frames collected during one CANManager::Process() call are passed at once
+using can_send_batch_function_t = void (*)(can_frame_t *frames, uint8_t count);
+// tag of the CANManager constructor with the batched sending function: CANManager<>(CAN_SEND_BATCH, func)
+struct can_send_batch_tag_t
+{
+};
+constexpr can_send_batch_tag_t CAN_SEND_BATCH = {};
+
+// free-running counter for time budgets of CANManager::Process(): CPU cycles, microseconds or any other units
+using can_clock_function_t = uint32_t (*)();
+const uint32_t CAN_PROCESS_BUDGET_UNLIMITED = UINT32_MAX;
+
 // can_function_id_t must have a size of 1 byte
 // otherwise we need to update can_frame_t structure
 static_assert(sizeof(can_function_id_t) == 1);
@@ -118,6 +190,38 @@ enum event_type_t : uint8_t
     CAN_EVENT_TYPE_MASK = 0b11110000,
 };
 
+// Automatic functions of CANObject (CANObject::Process()).
+// Bits are ordered by priority: the lowest bit is the most important one.
+enum can_auto_function_t : uint8_t
+{
+    CAN_AUTO_FUNC_NONE = 0b00000000,
+    CAN_AUTO_FUNC_REALTIME = 0b00000001,
+    CAN_AUTO_FUNC_EVENT = 0b00000010,
+    CAN_AUTO_FUNC_ERROR_EVENT = 0b00000100,
+    CAN_AUTO_FUNC_TIMER = 0b00001000,
+
+    CAN_AUTO_FUNC_FIRST = CAN_AUTO_FUNC_REALTIME,
+};
+
+// Order in which CANManager processes registered CANObjects every tick
+enum can_scheduling_policy_t : uint8_t
+{
+    CAN_SCHEDULING_REGISTRATION_ORDER = 0x00,      // objects are processed in the order of registration
+    CAN_SCHEDULING_ROUND_ROBIN = 0x01,             // the first object is shifted by one every tick
+    CAN_SCHEDULING_STATIC_PRIORITY = 0x02,         // objects with higher priority are processed first
+    CAN_SCHEDULING_EARLIEST_DEADLINE_FIRST = 0x03, // objects with the earliest due automatic function are processed first
+};
+
+// Per-object statistics of automatic functions collected by CANManager
+struct can_object_stats_t
+{
+    uint32_t frames_sent = 0;      // the number of automatic frames sent
+    uint32_t latency_total_ms = 0; // sum of latencies (time between the function became due and the frame was sent)
+    uint16_t latency_last_ms = 0;  // latency of the last frame
+    uint16_t latency_max_ms = 0;   // maximal latency
+    uint32_t skipped_ticks = 0;    // the number of ticks when the object had due functions, but the tick frame limit was reached
+};
+
 enum object_type_t : uint8_t
 {
     CAN_OBJECT_TYPE_UNKNOWN = 0x00,
@@ -127,6 +231,7 @@ enum object_type_t : uint8_t
     CAN_OBJECT_TYPE_SYSTEM_BLOCK_FEATURES = 0x04,
     CAN_OBJECT_TYPE_SYSTEM_BLOCK_ERROR = 0x05,
     CAN_OBJECT_TYPE_SILENT = 0x06,
+    CAN_OBJECT_TYPE_SYSTEM_BLOCK_STATS = 0x07,
 };
 
 enum lock_func_level_t : uint8_t
@@ -176,6 +281,7 @@ enum error_code_manager_t : uint8_t
 {
     ERROR_CODE_MANAGER_NONE = 0x00,
     ERROR_CODE_MANAGER_CAN_FRAME_AND_ERROR_STRUCT_ARE_BOTH_BLANK = 0x01,
+    ERROR_CODE_MANAGER_REMOTE_NODE_TIMEOUT = 0x02,
 
     // NOTE: used for debug and as a temporary value; should not be used in release code
     ERROR_CODE_MANAGER_SOMETHING_WRONG = 0xFF,
@@ -208,6 +314,52 @@ using set_realtime_handler_t = can_result_t (*)(can_frame_t &can_frame, can_erro
 using set_realtime_error_handler_t = void (*)(uint32_t time_has_passed_ms);
 using toggle_handler_t = can_result_t (*)(can_frame_t &can_frame, can_error_t &error);
 using action_handler_t = can_result_t (*)(can_frame_t &can_frame, can_error_t &error);
+using custom_handler_t = can_result_t (*)(can_frame_t &can_frame, can_error_t &error);
+
+// The number of incoming function IDs (all IDs below CAN_FUNC_FIRST_OUT_OK)
+#define CAN_INPUT_FUNCTIONS_COUNT CAN_FUNC_FIRST_OUT_OK
+
+// Handlers of incoming functions
+enum can_input_handler_t : uint8_t
+{
+    CAN_INPUT_HANDLER_UNSUPPORTED = 0x00, // reserved and OUT function IDs
+    CAN_INPUT_HANDLER_CUSTOM = 0x01,      // free IN function IDs, handled by the registered custom handlers
+    CAN_INPUT_HANDLER_SET = 0x02,
+    CAN_INPUT_HANDLER_TOGGLE = 0x03,
+    CAN_INPUT_HANDLER_ACTION = 0x04,
+    CAN_INPUT_HANDLER_SET_REAL_TIME = 0x05,
+    CAN_INPUT_HANDLER_LOCK = 0x06,
+    CAN_INPUT_HANDLER_REQUEST = 0x07,
+    CAN_INPUT_HANDLER_SYSTEM_REQUEST = 0x08,
+
+    CAN_INPUT_HANDLER_COUNT = 0x09,
+};
+
+// Dispatch table of incoming functions: handler of every IN function ID. It is built at compile time.
+struct can_input_dispatch_t
+{
+    uint8_t handler_index[CAN_INPUT_FUNCTIONS_COUNT];
+
+    constexpr can_input_dispatch_t() : handler_index()
+    {
+        for (uint8_t func = CAN_FUNC_NONE + 1; func < CAN_INPUT_FUNCTIONS_COUNT; func++)
+            handler_index[func] = CAN_INPUT_HANDLER_CUSTOM;
+
+        handler_index[CAN_FUNC_NONE] = CAN_INPUT_HANDLER_UNSUPPORTED;
+        for (uint8_t func = CAN_FUNC_SEND_RAW_INIT_IN; func <= CAN_FUNC_SEND_RAW_FINISH_IN; func++)
+            handler_index[func] = CAN_INPUT_HANDLER_UNSUPPORTED;
+
+        handler_index[CAN_FUNC_SET_IN] = CAN_INPUT_HANDLER_SET;
+        handler_index[CAN_FUNC_TOGGLE_IN] = CAN_INPUT_HANDLER_TOGGLE;
+        handler_index[CAN_FUNC_ACTION_IN] = CAN_INPUT_HANDLER_ACTION;
+        handler_index[CAN_FUNC_SET_REAL_TIME_IN] = CAN_INPUT_HANDLER_SET_REAL_TIME;
+        handler_index[CAN_FUNC_LOCK_IN] = CAN_INPUT_HANDLER_LOCK;
+        handler_index[CAN_FUNC_REQUEST_IN] = CAN_INPUT_HANDLER_REQUEST;
+        handler_index[CAN_FUNC_SYSTEM_REQUEST_IN] = CAN_INPUT_HANDLER_SYSTEM_REQUEST;
+    }
+};
+
+constexpr can_input_dispatch_t can_input_dispatch;
 
 /*************************************************************************************************
  *
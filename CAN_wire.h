@@ -0,0 +1,99 @@
+#ifndef CAN_WIRE_H
+#define CAN_WIRE_H
+
+#include <stdint.h>
+#include <string.h>
+#include "pix_utils.h"
+
+/*******************************************************************************************\
+ *
+ * Wire byte order of CANObject data fields.
+ * All nodes of the bus must be built with the same CAN_WIRE_BYTE_ORDER (little-endian by default),
+ * then big- and little-endian nodes exchange multi-byte values without any conversion in user code.
+ * On the targets with the same byte order as the wire one the codec is a plain memcpy.
+ *
+\*******************************************************************************************/
+#define CAN_WIRE_LITTLE_ENDIAN __ORDER_LITTLE_ENDIAN__
+#define CAN_WIRE_BIG_ENDIAN __ORDER_BIG_ENDIAN__
+
+#ifndef CAN_WIRE_BYTE_ORDER
+#define CAN_WIRE_BYTE_ORDER CAN_WIRE_LITTLE_ENDIAN
+#endif
+
+#if CAN_WIRE_BYTE_ORDER != CAN_WIRE_LITTLE_ENDIAN && CAN_WIRE_BYTE_ORDER != CAN_WIRE_BIG_ENDIAN
+#error "CAN_WIRE_BYTE_ORDER must be CAN_WIRE_LITTLE_ENDIAN or CAN_WIRE_BIG_ENDIAN"
+#endif
+
+#define CAN_WIRE_SWAP_NEEDED (CAN_WIRE_BYTE_ORDER != __BYTE_ORDER__)
+
+// Byte order conversion of one data field: scalar types (integers, enums, float, double) are swapped,
+// structures are user defined layouts and are copied as is.
+template <typename T, bool _is_scalar = !__is_class(T) && !__is_union(T)>
+struct can_wire_codec
+{
+    static inline T Convert(T val)
+    {
+#if CAN_WIRE_SWAP_NEEDED
+        return swap_bytes(val);
+#else
+        return val;
+#endif
+    }
+};
+
+template <typename T>
+struct can_wire_codec<T, false>
+{
+    static inline T Convert(T val)
+    {
+        return val;
+    }
+};
+
+/// @brief Writes data fields into the frame payload in the wire byte order
+/// @tparam T — Data field type
+/// @param dst Frame payload
+/// @param src Data fields
+/// @param count The number of data fields
+template <typename T>
+inline void can_wire_encode(uint8_t *dst, const T *src, uint8_t count)
+{
+#if CAN_WIRE_SWAP_NEEDED
+    for (uint8_t i = 0; i < count; i++)
+    {
+        T val = can_wire_codec<T>::Convert(src[i]);
+        memcpy(dst + i * sizeof(T), &val, sizeof(T));
+    }
+#else
+    memcpy(dst, src, count * sizeof(T));
+#endif
+}
+
+/// @brief Reads data fields from the frame payload in the wire byte order
+/// @tparam T — Data field type
+/// @param dst Data fields
+/// @param src Frame payload (may be unaligned)
+/// @param count The number of data fields
+template <typename T>
+inline void can_wire_decode(T *dst, const uint8_t *src, uint8_t count)
+{
+    memcpy(dst, src, count * sizeof(T));
+#if CAN_WIRE_SWAP_NEEDED
+    for (uint8_t i = 0; i < count; i++)
+        dst[i] = can_wire_codec<T>::Convert(dst[i]);
+#endif
+}
+
+/// @brief Reads one data field from the frame payload in the wire byte order
+/// @tparam T — Data field type
+/// @param src Frame payload (may be unaligned)
+/// @return Value in the host byte order
+template <typename T>
+inline T can_wire_read(const uint8_t *src)
+{
+    T val;
+    can_wire_decode(&val, src, 1);
+    return val;
+}
+
+#endif // CAN_WIRE_H
@@ -2,35 +2,105 @@
 #define PIX_UTILS_H
 
 #include <stdint.h>
+#include <string.h>
 
 /*******************************************************************************************\
  *
  * Big Endian → Little Endian → Big Endian functions
  *
 \*******************************************************************************************/
+// unsigned integer of the same size and its byte swap (single instruction on most targets)
+template <uint8_t _size>
+struct pix_uint_of_size;
+
+template <>
+struct pix_uint_of_size<1>
+{
+    using type = uint8_t;
+    static inline type swap(type val) { return val; }
+};
+
+template <>
+struct pix_uint_of_size<2>
+{
+    using type = uint16_t;
+    static inline type swap(type val) { return __builtin_bswap16(val); }
+};
+
+template <>
+struct pix_uint_of_size<4>
+{
+    using type = uint32_t;
+    static inline type swap(type val) { return __builtin_bswap32(val); }
+};
+
+template <>
+struct pix_uint_of_size<8>
+{
+    using type = uint64_t;
+    static inline type swap(type val) { return __builtin_bswap64(val); }
+};
+
+// returns the value with reversed byte order; works for integers, enums, float & double
+// (memcpy instead of pointer casts: no strict aliasing issues, compiles to register moves)
+template <typename T>
+inline T swap_bytes(T val)
+{
+    using uint_t = typename pix_uint_of_size<sizeof(T)>::type;
+
+    uint_t raw;
+    memcpy(&raw, &val, sizeof(T));
+    raw = pix_uint_of_size<sizeof(T)>::swap(raw);
+    memcpy(&val, &raw, sizeof(T));
+    return val;
+}
+
 // swaps uint16 endian
 inline void swap_endian(uint16_t &val)
 {
-    val = (val << 8) | (val >> 8);
+    val = __builtin_bswap16(val);
 }
 
 // swaps int16 endian
 inline void swap_endian(int16_t &val)
 {
-    swap_endian(*(uint16_t *)&val);
+    val = swap_bytes(val);
 }
 
 // swaps uint32 endian
 inline void swap_endian(uint32_t &val)
 {
-    val = (val << 24) | ((val << 8) & 0x00ff0000) |
-          ((val >> 8) & 0x0000ff00) | (val >> 24);
+    val = __builtin_bswap32(val);
 }
 
 // swaps int32 endian
 inline void swap_endian(int32_t &val)
 {
-    swap_endian(*(uint32_t *)&val);
+    val = swap_bytes(val);
+}
+
+// swaps uint64 endian
+inline void swap_endian(uint64_t &val)
+{
+    val = __builtin_bswap64(val);
+}
+
+// swaps int64 endian
+inline void swap_endian(int64_t &val)
+{
+    val = swap_bytes(val);
+}
+
+// swaps float endian
+inline void swap_endian(float &val)
+{
+    val = swap_bytes(val);
+}
+
+// swaps double endian
+inline void swap_endian(double &val)
+{
+    val = swap_bytes(val);
 }
 
 /*******************************************************************************************\
@@ -40,4 +110,4 @@ inline void swap_endian(int32_t &val)
 \*******************************************************************************************/
 void reverse_array(uint8_t *array, uint8_t array_size);
 
-#endif // PIX_UTILS_H
\ No newline at end of file
+#endif // PIX_UTILS_H